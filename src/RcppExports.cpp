@@ -5,6 +5,121 @@
 
 using namespace Rcpp;
 
+// rline_graph_caller
+SEXP rline_graph_caller(Rcpp::StringVector input_u, Rcpp::StringVector input_v, Rcpp::NumericVector input_w);
+RcppExport SEXP _rline_rline_graph_caller(SEXP input_uSEXP, SEXP input_vSEXP, SEXP input_wSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type input_u(input_uSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type input_v(input_vSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type input_w(input_wSEXP);
+    rcpp_result_gen = Rcpp::wrap(rline_graph_caller(input_u, input_v, input_w));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rline_graph_save_caller
+bool rline_graph_save_caller(SEXP graph, std::string file, bool alias);
+RcppExport SEXP _rline_rline_graph_save_caller(SEXP graphSEXP, SEXP fileSEXP, SEXP aliasSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type graph(graphSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< bool >::type alias(aliasSEXP);
+    rcpp_result_gen = Rcpp::wrap(rline_graph_save_caller(graph, file, alias));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rline_graph_load_caller
+SEXP rline_graph_load_caller(std::string file, bool verify);
+RcppExport SEXP _rline_rline_graph_load_caller(SEXP fileSEXP, SEXP verifySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< bool >::type verify(verifySEXP);
+    rcpp_result_gen = Rcpp::wrap(rline_graph_load_caller(file, verify));
+    return rcpp_result_gen;
+END_RCPP
+}
+// graph_info_caller
+Rcpp::List graph_info_caller(SEXP graph);
+RcppExport SEXP _rline_graph_info_caller(SEXP graphSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type graph(graphSEXP);
+    rcpp_result_gen = Rcpp::wrap(graph_info_caller(graph));
+    return rcpp_result_gen;
+END_RCPP
+}
+// graph_vertices_caller
+Rcpp::StringVector graph_vertices_caller(SEXP graph);
+RcppExport SEXP _rline_graph_vertices_caller(SEXP graphSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type graph(graphSEXP);
+    rcpp_result_gen = Rcpp::wrap(graph_vertices_caller(graph));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rline_edges_caller
+SEXP rline_edges_caller(std::string file);
+RcppExport SEXP _rline_rline_edges_caller(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(rline_edges_caller(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rline_edges_convert_caller
+bool rline_edges_convert_caller(std::string text_file, std::string binary_file);
+RcppExport SEXP _rline_rline_edges_convert_caller(SEXP text_fileSEXP, SEXP binary_fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type text_file(text_fileSEXP);
+    Rcpp::traits::input_parameter< std::string >::type binary_file(binary_fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(rline_edges_convert_caller(text_file, binary_file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// edges_info_caller
+Rcpp::List edges_info_caller(SEXP edges);
+RcppExport SEXP _rline_edges_info_caller(SEXP edgesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type edges(edgesSEXP);
+    rcpp_result_gen = Rcpp::wrap(edges_info_caller(edges));
+    return rcpp_result_gen;
+END_RCPP
+}
+// arrow_structs_caller
+SEXP arrow_structs_caller();
+RcppExport SEXP _rline_arrow_structs_caller() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(arrow_structs_caller());
+    return rcpp_result_gen;
+END_RCPP
+}
+// arrow_addresses_caller
+Rcpp::NumericVector arrow_addresses_caller(SEXP structs);
+RcppExport SEXP _rline_arrow_addresses_caller(SEXP structsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type structs(structsSEXP);
+    rcpp_result_gen = Rcpp::wrap(arrow_addresses_caller(structs));
+    return rcpp_result_gen;
+END_RCPP
+}
 // reconstruct_caller
 Rcpp::DataFrame reconstruct_caller(Rcpp::StringVector input_u, Rcpp::StringVector input_v, Rcpp::NumericVector input_w, int max_depth, int max_k);
 RcppExport SEXP _rline_reconstruct_caller(SEXP input_uSEXP, SEXP input_vSEXP, SEXP input_wSEXP, SEXP max_depthSEXP, SEXP max_kSEXP) {
@@ -20,9 +135,64 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// reconstruct_store_caller
+Rcpp::DataFrame reconstruct_store_caller(SEXP graph, int max_depth, int max_k);
+RcppExport SEXP _rline_reconstruct_store_caller(SEXP graphSEXP, SEXP max_depthSEXP, SEXP max_kSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type graph(graphSEXP);
+    Rcpp::traits::input_parameter< int >::type max_depth(max_depthSEXP);
+    Rcpp::traits::input_parameter< int >::type max_k(max_kSEXP);
+    rcpp_result_gen = Rcpp::wrap(reconstruct_store_caller(graph, max_depth, max_k));
+    return rcpp_result_gen;
+END_RCPP
+}
+// reconstruct_arrow_caller
+Rcpp::DataFrame reconstruct_arrow_caller(SEXP batch, int max_depth, int max_k);
+RcppExport SEXP _rline_reconstruct_arrow_caller(SEXP batchSEXP, SEXP max_depthSEXP, SEXP max_kSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type batch(batchSEXP);
+    Rcpp::traits::input_parameter< int >::type max_depth(max_depthSEXP);
+    Rcpp::traits::input_parameter< int >::type max_k(max_kSEXP);
+    rcpp_result_gen = Rcpp::wrap(reconstruct_arrow_caller(batch, max_depth, max_k));
+    return rcpp_result_gen;
+END_RCPP
+}
+// reconstruct_edges_caller
+Rcpp::DataFrame reconstruct_edges_caller(SEXP edges, int max_depth, int max_k);
+RcppExport SEXP _rline_reconstruct_edges_caller(SEXP edgesSEXP, SEXP max_depthSEXP, SEXP max_kSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type edges(edgesSEXP);
+    Rcpp::traits::input_parameter< int >::type max_depth(max_depthSEXP);
+    Rcpp::traits::input_parameter< int >::type max_k(max_kSEXP);
+    rcpp_result_gen = Rcpp::wrap(reconstruct_edges_caller(edges, max_depth, max_k));
+    return rcpp_result_gen;
+END_RCPP
+}
+// reconstruct_graph_caller
+Rcpp::DataFrame reconstruct_graph_caller(Rcpp::IntegerVector p, Rcpp::IntegerVector i, Rcpp::NumericVector x, Rcpp::StringVector names, int max_depth, int max_k);
+RcppExport SEXP _rline_reconstruct_graph_caller(SEXP pSEXP, SEXP iSEXP, SEXP xSEXP, SEXP namesSEXP, SEXP max_depthSEXP, SEXP max_kSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type p(pSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type i(iSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type names(namesSEXP);
+    Rcpp::traits::input_parameter< int >::type max_depth(max_depthSEXP);
+    Rcpp::traits::input_parameter< int >::type max_k(max_kSEXP);
+    rcpp_result_gen = Rcpp::wrap(reconstruct_graph_caller(p, i, x, names, max_depth, max_k));
+    return rcpp_result_gen;
+END_RCPP
+}
 // line_caller
-Rcpp::NumericMatrix line_caller(Rcpp::StringVector input_u, Rcpp::StringVector input_v, Rcpp::NumericVector input_w, int binary, int dim, int order, int negative, int samples, float rho, int threads);
-RcppExport SEXP _rline_line_caller(SEXP input_uSEXP, SEXP input_vSEXP, SEXP input_wSEXP, SEXP binarySEXP, SEXP dimSEXP, SEXP orderSEXP, SEXP negativeSEXP, SEXP samplesSEXP, SEXP rhoSEXP, SEXP threadsSEXP) {
+SEXP line_caller(Rcpp::StringVector input_u, Rcpp::StringVector input_v, Rcpp::NumericVector input_w, int binary, int dim, int order, int negative, int samples, float rho, int threads, double memory_budget, bool context, double hub_vertices, bool huge_pages, SEXP arrow_output);
+RcppExport SEXP _rline_line_caller(SEXP input_uSEXP, SEXP input_vSEXP, SEXP input_wSEXP, SEXP binarySEXP, SEXP dimSEXP, SEXP orderSEXP, SEXP negativeSEXP, SEXP samplesSEXP, SEXP rhoSEXP, SEXP threadsSEXP, SEXP memory_budgetSEXP, SEXP contextSEXP, SEXP hub_verticesSEXP, SEXP huge_pagesSEXP, SEXP arrow_outputSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -36,30 +206,463 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< int >::type samples(samplesSEXP);
     Rcpp::traits::input_parameter< float >::type rho(rhoSEXP);
     Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
-    rcpp_result_gen = Rcpp::wrap(line_caller(input_u, input_v, input_w, binary, dim, order, negative, samples, rho, threads));
+    Rcpp::traits::input_parameter< double >::type memory_budget(memory_budgetSEXP);
+    Rcpp::traits::input_parameter< bool >::type context(contextSEXP);
+    Rcpp::traits::input_parameter< double >::type hub_vertices(hub_verticesSEXP);
+    Rcpp::traits::input_parameter< bool >::type huge_pages(huge_pagesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type arrow_output(arrow_outputSEXP);
+    rcpp_result_gen = Rcpp::wrap(line_caller(input_u, input_v, input_w, binary, dim, order, negative, samples, rho, threads, memory_budget, context, hub_vertices, huge_pages, arrow_output));
+    return rcpp_result_gen;
+END_RCPP
+}
+// line_store_caller
+SEXP line_store_caller(SEXP graph, int binary, int dim, int order, int negative, int samples, float rho, int threads, double memory_budget, bool context, double hub_vertices, bool huge_pages, SEXP arrow_output);
+RcppExport SEXP _rline_line_store_caller(SEXP graphSEXP, SEXP binarySEXP, SEXP dimSEXP, SEXP orderSEXP, SEXP negativeSEXP, SEXP samplesSEXP, SEXP rhoSEXP, SEXP threadsSEXP, SEXP memory_budgetSEXP, SEXP contextSEXP, SEXP hub_verticesSEXP, SEXP huge_pagesSEXP, SEXP arrow_outputSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type graph(graphSEXP);
+    Rcpp::traits::input_parameter< int >::type binary(binarySEXP);
+    Rcpp::traits::input_parameter< int >::type dim(dimSEXP);
+    Rcpp::traits::input_parameter< int >::type order(orderSEXP);
+    Rcpp::traits::input_parameter< int >::type negative(negativeSEXP);
+    Rcpp::traits::input_parameter< int >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< float >::type rho(rhoSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type memory_budget(memory_budgetSEXP);
+    Rcpp::traits::input_parameter< bool >::type context(contextSEXP);
+    Rcpp::traits::input_parameter< double >::type hub_vertices(hub_verticesSEXP);
+    Rcpp::traits::input_parameter< bool >::type huge_pages(huge_pagesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type arrow_output(arrow_outputSEXP);
+    rcpp_result_gen = Rcpp::wrap(line_store_caller(graph, binary, dim, order, negative, samples, rho, threads, memory_budget, context, hub_vertices, huge_pages, arrow_output));
+    return rcpp_result_gen;
+END_RCPP
+}
+// line_arrow_caller
+SEXP line_arrow_caller(SEXP batch, int binary, int dim, int order, int negative, int samples, float rho, int threads, double memory_budget, bool context, double hub_vertices, bool huge_pages, SEXP arrow_output);
+RcppExport SEXP _rline_line_arrow_caller(SEXP batchSEXP, SEXP binarySEXP, SEXP dimSEXP, SEXP orderSEXP, SEXP negativeSEXP, SEXP samplesSEXP, SEXP rhoSEXP, SEXP threadsSEXP, SEXP memory_budgetSEXP, SEXP contextSEXP, SEXP hub_verticesSEXP, SEXP huge_pagesSEXP, SEXP arrow_outputSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type batch(batchSEXP);
+    Rcpp::traits::input_parameter< int >::type binary(binarySEXP);
+    Rcpp::traits::input_parameter< int >::type dim(dimSEXP);
+    Rcpp::traits::input_parameter< int >::type order(orderSEXP);
+    Rcpp::traits::input_parameter< int >::type negative(negativeSEXP);
+    Rcpp::traits::input_parameter< int >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< float >::type rho(rhoSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type memory_budget(memory_budgetSEXP);
+    Rcpp::traits::input_parameter< bool >::type context(contextSEXP);
+    Rcpp::traits::input_parameter< double >::type hub_vertices(hub_verticesSEXP);
+    Rcpp::traits::input_parameter< bool >::type huge_pages(huge_pagesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type arrow_output(arrow_outputSEXP);
+    rcpp_result_gen = Rcpp::wrap(line_arrow_caller(batch, binary, dim, order, negative, samples, rho, threads, memory_budget, context, hub_vertices, huge_pages, arrow_output));
+    return rcpp_result_gen;
+END_RCPP
+}
+// line_edges_caller
+SEXP line_edges_caller(SEXP edges, int binary, int dim, int order, int negative, int samples, float rho, int threads, double memory_budget, bool context, double hub_vertices, bool huge_pages, SEXP arrow_output);
+RcppExport SEXP _rline_line_edges_caller(SEXP edgesSEXP, SEXP binarySEXP, SEXP dimSEXP, SEXP orderSEXP, SEXP negativeSEXP, SEXP samplesSEXP, SEXP rhoSEXP, SEXP threadsSEXP, SEXP memory_budgetSEXP, SEXP contextSEXP, SEXP hub_verticesSEXP, SEXP huge_pagesSEXP, SEXP arrow_outputSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type edges(edgesSEXP);
+    Rcpp::traits::input_parameter< int >::type binary(binarySEXP);
+    Rcpp::traits::input_parameter< int >::type dim(dimSEXP);
+    Rcpp::traits::input_parameter< int >::type order(orderSEXP);
+    Rcpp::traits::input_parameter< int >::type negative(negativeSEXP);
+    Rcpp::traits::input_parameter< int >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< float >::type rho(rhoSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type memory_budget(memory_budgetSEXP);
+    Rcpp::traits::input_parameter< bool >::type context(contextSEXP);
+    Rcpp::traits::input_parameter< double >::type hub_vertices(hub_verticesSEXP);
+    Rcpp::traits::input_parameter< bool >::type huge_pages(huge_pagesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type arrow_output(arrow_outputSEXP);
+    rcpp_result_gen = Rcpp::wrap(line_edges_caller(edges, binary, dim, order, negative, samples, rho, threads, memory_budget, context, hub_vertices, huge_pages, arrow_output));
+    return rcpp_result_gen;
+END_RCPP
+}
+// line_graph_caller
+SEXP line_graph_caller(Rcpp::IntegerVector p, Rcpp::IntegerVector i, Rcpp::NumericVector x, Rcpp::StringVector names, int binary, int dim, int order, int negative, int samples, float rho, int threads, double memory_budget, bool context, double hub_vertices, bool huge_pages, SEXP arrow_output);
+RcppExport SEXP _rline_line_graph_caller(SEXP pSEXP, SEXP iSEXP, SEXP xSEXP, SEXP namesSEXP, SEXP binarySEXP, SEXP dimSEXP, SEXP orderSEXP, SEXP negativeSEXP, SEXP samplesSEXP, SEXP rhoSEXP, SEXP threadsSEXP, SEXP memory_budgetSEXP, SEXP contextSEXP, SEXP hub_verticesSEXP, SEXP huge_pagesSEXP, SEXP arrow_outputSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type p(pSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type i(iSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type names(namesSEXP);
+    Rcpp::traits::input_parameter< int >::type binary(binarySEXP);
+    Rcpp::traits::input_parameter< int >::type dim(dimSEXP);
+    Rcpp::traits::input_parameter< int >::type order(orderSEXP);
+    Rcpp::traits::input_parameter< int >::type negative(negativeSEXP);
+    Rcpp::traits::input_parameter< int >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< float >::type rho(rhoSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type memory_budget(memory_budgetSEXP);
+    Rcpp::traits::input_parameter< bool >::type context(contextSEXP);
+    Rcpp::traits::input_parameter< double >::type hub_vertices(hub_verticesSEXP);
+    Rcpp::traits::input_parameter< bool >::type huge_pages(huge_pagesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type arrow_output(arrow_outputSEXP);
+    rcpp_result_gen = Rcpp::wrap(line_graph_caller(p, i, x, names, binary, dim, order, negative, samples, rho, threads, memory_budget, context, hub_vertices, huge_pages, arrow_output));
     return rcpp_result_gen;
 END_RCPP
 }
 // concatenate_caller
-Rcpp::NumericMatrix concatenate_caller(Rcpp::NumericMatrix input_one, Rcpp::NumericMatrix input_two, Rcpp::StringVector first_order_v, Rcpp::StringVector second_order_v, int binary);
-RcppExport SEXP _rline_concatenate_caller(SEXP input_oneSEXP, SEXP input_twoSEXP, SEXP first_order_vSEXP, SEXP second_order_vSEXP, SEXP binarySEXP) {
+Rcpp::NumericMatrix concatenate_caller(Rcpp::NumericMatrix input_one, Rcpp::NumericMatrix input_two, Rcpp::StringVector first_order_v, Rcpp::StringVector second_order_v, int binary, int threads, std::string join, std::string fill);
+RcppExport SEXP _rline_concatenate_caller(SEXP input_oneSEXP, SEXP input_twoSEXP, SEXP first_order_vSEXP, SEXP second_order_vSEXP, SEXP binarySEXP, SEXP threadsSEXP, SEXP joinSEXP, SEXP fillSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type input_one(input_oneSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type input_two(input_twoSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type first_order_v(first_order_vSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type second_order_v(second_order_vSEXP);
+    Rcpp::traits::input_parameter< int >::type binary(binarySEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type join(joinSEXP);
+    Rcpp::traits::input_parameter< std::string >::type fill(fillSEXP);
+    rcpp_result_gen = Rcpp::wrap(concatenate_caller(input_one, input_two, first_order_v, second_order_v, binary, threads, join, fill));
+    return rcpp_result_gen;
+END_RCPP
+}
+// concatenate_store_caller
+Rcpp::NumericMatrix concatenate_store_caller(SEXP graph, Rcpp::NumericMatrix input_one, Rcpp::NumericMatrix input_two, Rcpp::StringVector first_order_v, Rcpp::StringVector second_order_v, int binary, int threads, std::string fill);
+RcppExport SEXP _rline_concatenate_store_caller(SEXP graphSEXP, SEXP input_oneSEXP, SEXP input_twoSEXP, SEXP first_order_vSEXP, SEXP second_order_vSEXP, SEXP binarySEXP, SEXP threadsSEXP, SEXP fillSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type graph(graphSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type input_one(input_oneSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type input_two(input_twoSEXP);
     Rcpp::traits::input_parameter< Rcpp::StringVector >::type first_order_v(first_order_vSEXP);
     Rcpp::traits::input_parameter< Rcpp::StringVector >::type second_order_v(second_order_vSEXP);
     Rcpp::traits::input_parameter< int >::type binary(binarySEXP);
-    rcpp_result_gen = Rcpp::wrap(concatenate_caller(input_one, input_two, first_order_v, second_order_v, binary));
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type fill(fillSEXP);
+    rcpp_result_gen = Rcpp::wrap(concatenate_store_caller(graph, input_one, input_two, first_order_v, second_order_v, binary, threads, fill));
+    return rcpp_result_gen;
+END_RCPP
+}
+// normalize_caller
+Rcpp::NumericMatrix normalize_caller(Rcpp::NumericMatrix input_matrix, bool in_place, bool line_precision, int threads);
+RcppExport SEXP _rline_normalize_caller(SEXP input_matrixSEXP, SEXP in_placeSEXP, SEXP line_precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type input_matrix(input_matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type in_place(in_placeSEXP);
+    Rcpp::traits::input_parameter< bool >::type line_precision(line_precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(normalize_caller(input_matrix, in_place, line_precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// benchmark_update_caller
+Rcpp::DataFrame benchmark_update_caller(Rcpp::IntegerVector dims, Rcpp::NumericVector working_set_mb, Rcpp::LogicalVector huge_pages, double samples, int negative, int threads);
+RcppExport SEXP _rline_benchmark_update_caller(SEXP dimsSEXP, SEXP working_set_mbSEXP, SEXP huge_pagesSEXP, SEXP samplesSEXP, SEXP negativeSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type dims(dimsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type working_set_mb(working_set_mbSEXP);
+    Rcpp::traits::input_parameter< Rcpp::LogicalVector >::type huge_pages(huge_pagesSEXP);
+    Rcpp::traits::input_parameter< double >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< int >::type negative(negativeSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(benchmark_update_caller(dims, working_set_mb, huge_pages, samples, negative, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// perf_counters_caller
+bool perf_counters_caller(bool enable);
+RcppExport SEXP _rline_perf_counters_caller(SEXP enableSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< bool >::type enable(enableSEXP);
+    rcpp_result_gen = Rcpp::wrap(perf_counters_caller(enable));
+    return rcpp_result_gen;
+END_RCPP
+}
+// perf_report_caller
+Rcpp::DataFrame perf_report_caller();
+RcppExport SEXP _rline_perf_report_caller() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(perf_report_caller());
+    return rcpp_result_gen;
+END_RCPP
+}
+// trace_start_caller
+bool trace_start_caller(std::string file);
+RcppExport SEXP _rline_trace_start_caller(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(trace_start_caller(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// trace_stop_caller
+int trace_stop_caller();
+RcppExport SEXP _rline_trace_stop_caller() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(trace_stop_caller());
+    return rcpp_result_gen;
+END_RCPP
+}
+// line_vertex_id_limit_caller
+double line_vertex_id_limit_caller(double limit);
+RcppExport SEXP _rline_line_vertex_id_limit_caller(SEXP limitSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type limit(limitSEXP);
+    rcpp_result_gen = Rcpp::wrap(line_vertex_id_limit_caller(limit));
+    return rcpp_result_gen;
+END_RCPP
+}
+// line_read_threads_caller
+int line_read_threads_caller(int threads);
+RcppExport SEXP _rline_line_read_threads_caller(SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(line_read_threads_caller(threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// memory_report_caller
+Rcpp::DataFrame memory_report_caller();
+RcppExport SEXP _rline_memory_report_caller() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(memory_report_caller());
+    return rcpp_result_gen;
+END_RCPP
+}
+// hnsw_build_caller
+SEXP hnsw_build_caller(Rcpp::NumericMatrix embedding, Rcpp::StringVector names, std::string metric, int M, int ef_construction, int threads);
+RcppExport SEXP _rline_hnsw_build_caller(SEXP embeddingSEXP, SEXP namesSEXP, SEXP metricSEXP, SEXP MSEXP, SEXP ef_constructionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type embedding(embeddingSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type names(namesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type metric(metricSEXP);
+    Rcpp::traits::input_parameter< int >::type M(MSEXP);
+    Rcpp::traits::input_parameter< int >::type ef_construction(ef_constructionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(hnsw_build_caller(embedding, names, metric, M, ef_construction, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hnsw_search_caller
+Rcpp::List hnsw_search_caller(SEXP index, Rcpp::NumericMatrix query, int k, int ef, int threads);
+RcppExport SEXP _rline_hnsw_search_caller(SEXP indexSEXP, SEXP querySEXP, SEXP kSEXP, SEXP efSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type query(querySEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< int >::type ef(efSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(hnsw_search_caller(index, query, k, ef, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hnsw_info_caller
+Rcpp::List hnsw_info_caller(SEXP index);
+RcppExport SEXP _rline_hnsw_info_caller(SEXP indexSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type index(indexSEXP);
+    rcpp_result_gen = Rcpp::wrap(hnsw_info_caller(index));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hnsw_save_caller
+bool hnsw_save_caller(SEXP index, std::string file);
+RcppExport SEXP _rline_hnsw_save_caller(SEXP indexSEXP, SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(hnsw_save_caller(index, file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hnsw_load_caller
+SEXP hnsw_load_caller(std::string file);
+RcppExport SEXP _rline_hnsw_load_caller(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(hnsw_load_caller(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// top_k_caller
+Rcpp::List top_k_caller(Rcpp::NumericMatrix embedding, int k, std::string metric, bool exclude_self, int threads);
+RcppExport SEXP _rline_top_k_caller(SEXP embeddingSEXP, SEXP kSEXP, SEXP metricSEXP, SEXP exclude_selfSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type embedding(embeddingSEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< std::string >::type metric(metricSEXP);
+    Rcpp::traits::input_parameter< bool >::type exclude_self(exclude_selfSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(top_k_caller(embedding, k, metric, exclude_self, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// link_prediction_caller
+Rcpp::List link_prediction_caller(Rcpp::NumericMatrix embedding, Rcpp::IntegerVector source, Rcpp::IntegerVector target, Rcpp::IntegerVector graph_u, Rcpp::IntegerVector graph_v, Rcpp::NumericVector graph_w, int negative, std::string metric, double seed, Rcpp::NumericVector k, int threads);
+RcppExport SEXP _rline_link_prediction_caller(SEXP embeddingSEXP, SEXP sourceSEXP, SEXP targetSEXP, SEXP graph_uSEXP, SEXP graph_vSEXP, SEXP graph_wSEXP, SEXP negativeSEXP, SEXP metricSEXP, SEXP seedSEXP, SEXP kSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type embedding(embeddingSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type source(sourceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type target(targetSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type graph_u(graph_uSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type graph_v(graph_vSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type graph_w(graph_wSEXP);
+    Rcpp::traits::input_parameter< int >::type negative(negativeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type metric(metricSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type k(kSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(link_prediction_caller(embedding, source, target, graph_u, graph_v, graph_w, negative, metric, seed, k, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fold_in_caller
+Rcpp::NumericMatrix fold_in_caller(Rcpp::NumericMatrix embedding, Rcpp::NumericMatrix context, Rcpp::IntegerVector source, Rcpp::IntegerVector target, Rcpp::NumericVector weight, Rcpp::StringVector new_vertices, Rcpp::IntegerVector graph_u, Rcpp::IntegerVector graph_v, Rcpp::NumericVector graph_w, int order, int negative, double samples, float rho, int threads);
+RcppExport SEXP _rline_fold_in_caller(SEXP embeddingSEXP, SEXP contextSEXP, SEXP sourceSEXP, SEXP targetSEXP, SEXP weightSEXP, SEXP new_verticesSEXP, SEXP graph_uSEXP, SEXP graph_vSEXP, SEXP graph_wSEXP, SEXP orderSEXP, SEXP negativeSEXP, SEXP samplesSEXP, SEXP rhoSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type embedding(embeddingSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type context(contextSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type source(sourceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type target(targetSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type weight(weightSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type new_vertices(new_verticesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type graph_u(graph_uSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type graph_v(graph_vSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type graph_w(graph_wSEXP);
+    Rcpp::traits::input_parameter< int >::type order(orderSEXP);
+    Rcpp::traits::input_parameter< int >::type negative(negativeSEXP);
+    Rcpp::traits::input_parameter< double >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< float >::type rho(rhoSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(fold_in_caller(embedding, context, source, target, weight, new_vertices, graph_u, graph_v, graph_w, order, negative, samples, rho, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// walk_caller
+Rcpp::NumericMatrix walk_caller(Rcpp::IntegerVector source, Rcpp::IntegerVector target, Rcpp::NumericVector weight, Rcpp::StringVector vertices, int dim, int walk_length, int num_walks, int window, double p, double q, int negative, float rho, int threads);
+RcppExport SEXP _rline_walk_caller(SEXP sourceSEXP, SEXP targetSEXP, SEXP weightSEXP, SEXP verticesSEXP, SEXP dimSEXP, SEXP walk_lengthSEXP, SEXP num_walksSEXP, SEXP windowSEXP, SEXP pSEXP, SEXP qSEXP, SEXP negativeSEXP, SEXP rhoSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type source(sourceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type target(targetSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type weight(weightSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type vertices(verticesSEXP);
+    Rcpp::traits::input_parameter< int >::type dim(dimSEXP);
+    Rcpp::traits::input_parameter< int >::type walk_length(walk_lengthSEXP);
+    Rcpp::traits::input_parameter< int >::type num_walks(num_walksSEXP);
+    Rcpp::traits::input_parameter< int >::type window(windowSEXP);
+    Rcpp::traits::input_parameter< double >::type p(pSEXP);
+    Rcpp::traits::input_parameter< double >::type q(qSEXP);
+    Rcpp::traits::input_parameter< int >::type negative(negativeSEXP);
+    Rcpp::traits::input_parameter< float >::type rho(rhoSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(walk_caller(source, target, weight, vertices, dim, walk_length, num_walks, window, p, q, negative, rho, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pte_caller
+Rcpp::NumericMatrix pte_caller(Rcpp::IntegerVector source, Rcpp::IntegerVector target, Rcpp::NumericVector weight, Rcpp::IntegerVector relation, Rcpp::StringVector vertices, Rcpp::NumericVector relation_weight, int dim, int order, int negative, double samples, float rho, int threads);
+RcppExport SEXP _rline_pte_caller(SEXP sourceSEXP, SEXP targetSEXP, SEXP weightSEXP, SEXP relationSEXP, SEXP verticesSEXP, SEXP relation_weightSEXP, SEXP dimSEXP, SEXP orderSEXP, SEXP negativeSEXP, SEXP samplesSEXP, SEXP rhoSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type source(sourceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type target(targetSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type weight(weightSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type relation(relationSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type vertices(verticesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type relation_weight(relation_weightSEXP);
+    Rcpp::traits::input_parameter< int >::type dim(dimSEXP);
+    Rcpp::traits::input_parameter< int >::type order(orderSEXP);
+    Rcpp::traits::input_parameter< int >::type negative(negativeSEXP);
+    Rcpp::traits::input_parameter< double >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< float >::type rho(rhoSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(pte_caller(source, target, weight, relation, vertices, relation_weight, dim, order, negative, samples, rho, threads));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
+    {"_rline_rline_graph_caller", (DL_FUNC) &_rline_rline_graph_caller, 3},
+    {"_rline_rline_graph_save_caller", (DL_FUNC) &_rline_rline_graph_save_caller, 3},
+    {"_rline_rline_graph_load_caller", (DL_FUNC) &_rline_rline_graph_load_caller, 2},
+    {"_rline_graph_info_caller", (DL_FUNC) &_rline_graph_info_caller, 1},
+    {"_rline_graph_vertices_caller", (DL_FUNC) &_rline_graph_vertices_caller, 1},
+    {"_rline_rline_edges_caller", (DL_FUNC) &_rline_rline_edges_caller, 1},
+    {"_rline_rline_edges_convert_caller", (DL_FUNC) &_rline_rline_edges_convert_caller, 2},
+    {"_rline_edges_info_caller", (DL_FUNC) &_rline_edges_info_caller, 1},
+    {"_rline_arrow_structs_caller", (DL_FUNC) &_rline_arrow_structs_caller, 0},
+    {"_rline_arrow_addresses_caller", (DL_FUNC) &_rline_arrow_addresses_caller, 1},
     {"_rline_reconstruct_caller", (DL_FUNC) &_rline_reconstruct_caller, 5},
-    {"_rline_line_caller", (DL_FUNC) &_rline_line_caller, 10},
-    {"_rline_concatenate_caller", (DL_FUNC) &_rline_concatenate_caller, 5},
+    {"_rline_reconstruct_store_caller", (DL_FUNC) &_rline_reconstruct_store_caller, 3},
+    {"_rline_reconstruct_arrow_caller", (DL_FUNC) &_rline_reconstruct_arrow_caller, 3},
+    {"_rline_reconstruct_edges_caller", (DL_FUNC) &_rline_reconstruct_edges_caller, 3},
+    {"_rline_reconstruct_graph_caller", (DL_FUNC) &_rline_reconstruct_graph_caller, 6},
+    {"_rline_line_caller", (DL_FUNC) &_rline_line_caller, 15},
+    {"_rline_line_store_caller", (DL_FUNC) &_rline_line_store_caller, 13},
+    {"_rline_line_arrow_caller", (DL_FUNC) &_rline_line_arrow_caller, 13},
+    {"_rline_line_edges_caller", (DL_FUNC) &_rline_line_edges_caller, 13},
+    {"_rline_line_graph_caller", (DL_FUNC) &_rline_line_graph_caller, 16},
+    {"_rline_concatenate_caller", (DL_FUNC) &_rline_concatenate_caller, 8},
+    {"_rline_concatenate_store_caller", (DL_FUNC) &_rline_concatenate_store_caller, 8},
+    {"_rline_normalize_caller", (DL_FUNC) &_rline_normalize_caller, 4},
+    {"_rline_benchmark_update_caller", (DL_FUNC) &_rline_benchmark_update_caller, 6},
+    {"_rline_perf_counters_caller", (DL_FUNC) &_rline_perf_counters_caller, 1},
+    {"_rline_perf_report_caller", (DL_FUNC) &_rline_perf_report_caller, 0},
+    {"_rline_trace_start_caller", (DL_FUNC) &_rline_trace_start_caller, 1},
+    {"_rline_trace_stop_caller", (DL_FUNC) &_rline_trace_stop_caller, 0},
+    {"_rline_line_vertex_id_limit_caller", (DL_FUNC) &_rline_line_vertex_id_limit_caller, 1},
+    {"_rline_line_read_threads_caller", (DL_FUNC) &_rline_line_read_threads_caller, 1},
+    {"_rline_memory_report_caller", (DL_FUNC) &_rline_memory_report_caller, 0},
+    {"_rline_hnsw_build_caller", (DL_FUNC) &_rline_hnsw_build_caller, 6},
+    {"_rline_hnsw_search_caller", (DL_FUNC) &_rline_hnsw_search_caller, 5},
+    {"_rline_hnsw_info_caller", (DL_FUNC) &_rline_hnsw_info_caller, 1},
+    {"_rline_hnsw_save_caller", (DL_FUNC) &_rline_hnsw_save_caller, 2},
+    {"_rline_hnsw_load_caller", (DL_FUNC) &_rline_hnsw_load_caller, 1},
+    {"_rline_top_k_caller", (DL_FUNC) &_rline_top_k_caller, 5},
+    {"_rline_link_prediction_caller", (DL_FUNC) &_rline_link_prediction_caller, 11},
+    {"_rline_fold_in_caller", (DL_FUNC) &_rline_fold_in_caller, 14},
+    {"_rline_walk_caller", (DL_FUNC) &_rline_walk_caller, 13},
+    {"_rline_pte_caller", (DL_FUNC) &_rline_pte_caller, 12},
     {NULL, NULL, 0}
 };
 
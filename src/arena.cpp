@@ -0,0 +1,65 @@
+/*
+Bump allocator for vertex names and per-call scratch.
+
+Millions of small allocations, one per vertex name, cost a malloc header each and have to be
+freed one by one. An arena hands out memory from large blocks instead and releases them all at
+once at the end of a call. Blocks double in size up to ARENA_MAX_BLOCK, so the number of blocks
+only grows with the logarithm of the bytes allocated until then.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+// Block headers take a whole alignment unit, so the first allocation of a block is aligned too
+static const size_t header_size = (sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+
+/* Returns NULL if out of memory */
+void *ArenaAlloc(Arena *arena, size_t bytes)
+{
+	bytes = (bytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+	if (arena->cur == NULL || (size_t)(arena->end - arena->cur) < bytes)
+	{
+		size_t size = arena->next_block;
+		if (size < bytes) size = bytes;
+		ArenaBlock *block = (ArenaBlock *)malloc(header_size + size);
+		if (block == NULL) return NULL;
+		block->next = arena->blocks;
+		arena->blocks = block;
+		arena->cur = (char *)block + header_size;
+		arena->end = arena->cur + size;
+		arena->bytes += header_size + size;
+		if (arena->next_block < ARENA_MAX_BLOCK) arena->next_block *= 2;
+	}
+	void *p = arena->cur;
+	arena->cur += bytes;
+	return p;
+}
+
+void *ArenaCalloc(Arena *arena, size_t count, size_t size)
+{
+	void *p = ArenaAlloc(arena, count * size);
+	if (p != NULL) memset(p, 0, count * size);
+	return p;
+}
+
+char *ArenaStrdup(Arena *arena, const char *s)
+{
+	size_t length = strlen(s) + 1;
+	char *p = (char *)ArenaAlloc(arena, length);
+	if (p != NULL) memcpy(p, s, length);
+	return p;
+}
+
+void ArenaRelease(Arena *arena)
+{
+	while (arena->blocks != NULL)
+	{
+		ArenaBlock *next = arena->blocks->next;
+		free(arena->blocks);
+		arena->blocks = next;
+	}
+	arena->cur = arena->end = NULL;
+	arena->next_block = ARENA_FIRST_BLOCK;
+	arena->bytes = 0;
+}
@@ -0,0 +1,29 @@
+#include <stddef.h>
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#define ARENA_FIRST_BLOCK (64 * 1024)
+#define ARENA_MAX_BLOCK (64 * 1024 * 1024)
+#define ARENA_ALIGNMENT 16
+
+struct ArenaBlock {
+	ArenaBlock *next;
+};
+
+// Bump allocator: allocations are carved out of blocks that double in size, and are only released
+// all at once. Zero initialized with ARENA_INIT.
+struct Arena {
+	ArenaBlock *blocks;
+	char *cur, *end;
+	size_t next_block;
+	long long bytes;                       // bytes of all blocks
+};
+
+#define ARENA_INIT { NULL, NULL, NULL, ARENA_FIRST_BLOCK, 0 }
+
+void *ArenaAlloc(Arena *arena, size_t bytes);
+void *ArenaCalloc(Arena *arena, size_t count, size_t size);
+char *ArenaStrdup(Arena *arena, const char *s);
+void ArenaRelease(Arena *arena);
+#endif
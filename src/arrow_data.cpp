@@ -0,0 +1,354 @@
+/*
+Edges in and embeddings out through the Arrow C Data Interface.
+
+ArrowEdgesOpen reads a record batch that an Arrow library exported, such as the arrow R package
+with RecordBatch$export_to_c, without copying its buffers: the source and target columns are
+dictionary encoded strings or integer vertex ids, and the weights floats. A dictionary column is
+numbered by visiting its indices in edge order and looking up each dictionary entry by name only
+the first time it is used, so no vertex name is hashed once per edge. The batch stays owned by
+the exporter and must outlive the ArrowEdges.
+
+ArrowExportEmbedding hands an embedding to an Arrow library as a record batch of a vertex name
+column and a fixed size list column of the rows, whose buffers are freed by the release callbacks
+of the batch once the importer is done with them.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <climits>
+#include "arrow_data.h"
+#include "trace.h"
+
+void ArrowStructsFree(ArrowStructs *structs)
+{
+	if (structs == NULL) return;
+	if (structs->array.release != NULL) structs->array.release(&structs->array);
+	if (structs->schema.release != NULL) structs->schema.release(&structs->schema);
+	free(structs);
+}
+
+/* Value k of an array of signed integers width bytes wide */
+static long long IntegerValue(const void *values, int width, long long k)
+{
+	switch (width)
+	{
+	case 1: return ((const int8_t *)values)[k];
+	case 2: return ((const int16_t *)values)[k];
+	case 4: return ((const int32_t *)values)[k];
+	default: return ((const int64_t *)values)[k];
+	}
+}
+
+/* Bytes of a signed integer of an Arrow format, 0 if the format is not one */
+static int IntegerWidth(const char *format)
+{
+	if (!strcmp(format, "c")) return 1;
+	if (!strcmp(format, "s")) return 2;
+	if (!strcmp(format, "i")) return 4;
+	if (!strcmp(format, "l")) return 8;
+	return 0;
+}
+
+/* Whether any of the length values of array from offset on is null */
+static int HasNulls(const ArrowArray *array, long long offset, long long length)
+{
+	if (array->null_count == 0) return 0;
+	if (array->null_count > 0) return 1;
+	if (array->n_buffers == 0 || array->buffers[0] == NULL) return 0;
+	const uint8_t *validity = (const uint8_t *)array->buffers[0];
+	for (long long k = offset; k != offset + length; k++)
+		if (!(validity[k >> 3] >> (k & 7) & 1)) return 1;
+	return 0;
+}
+
+/* Copy name, of length bytes, as a terminated string into the name arena, under a new vertex id */
+static long long AddName(ArrowEdges *edges, const char *name, size_t length)
+{
+	char *copy = (char *)ArenaAlloc(&edges->name_arena, length + 1);
+	if (copy == NULL) return -1;
+	memcpy(copy, name, length);
+	copy[length] = 0;
+	edges->names.push_back(copy);
+	return (long long)edges->names.size() - 1;
+}
+
+/* Describe column k of batch in column, checking its type; returns an error or NULL */
+static const char *OpenVertexColumn(const ArrowArray *batch, const ArrowSchema *schema, int k, ArrowVertexColumn *column)
+{
+	const ArrowArray *array = batch->children[k];
+	const ArrowSchema *type = schema->children[k];
+	column->width = IntegerWidth(type->format);
+	column->dictionary = type->dictionary != NULL ? array->dictionary : NULL;
+	if (column->width == 0 || (type->dictionary == NULL && column->width < 4))
+		return "has a vertex column that is neither dictionary encoded strings nor integer ids";
+	if (type->dictionary != NULL && (column->dictionary == NULL || (strcmp(type->dictionary->format, "u") && strcmp(type->dictionary->format, "U"))))
+		return "has a dictionary encoded vertex column whose dictionary is not strings";
+	if (array->n_buffers < 2 || HasNulls(array, array->offset + batch->offset, batch->length)) return "has missing vertices";
+	column->values = (const char *)array->buffers[1] + (array->offset + batch->offset) * column->width;
+	if (column->dictionary != NULL)
+	{
+		column->large = !strcmp(type->dictionary->format, "U");
+		column->vertex.assign(column->dictionary->length, -1);
+	}
+	return NULL;
+}
+
+/* Number the vertex of column at edge e if it is the first appearance of the vertex; returns an error or NULL */
+static const char *NumberVertex(ArrowEdges *edges, ArrowVertexColumn &column, std::unordered_map<std::string, long long> &dictionary_names,
+                                long long e)
+{
+	long long value = IntegerValue(column.values, column.width, e);
+	if (column.dictionary == NULL)
+	{
+		if (edges->ids.count(value)) return NULL;
+		char name[24];
+		snprintf(name, sizeof(name), "%lld", value);
+		long long id = AddName(edges, name, strlen(name));
+		if (id == -1) return "cannot be read, memory allocation failed";
+		edges->ids[value] = id;
+		return NULL;
+	}
+	if (value < 0 || value >= (long long)column.vertex.size()) return "has a dictionary index out of range";
+	if (column.vertex[value] != -1) return NULL;
+
+	// Every dictionary entry is looked up by name only once
+	long long k = column.dictionary->offset + value, begin, end;
+	if (column.large)
+	{
+		begin = ((const int64_t *)column.dictionary->buffers[1])[k];
+		end = ((const int64_t *)column.dictionary->buffers[1])[k + 1];
+	}
+	else
+	{
+		begin = ((const int32_t *)column.dictionary->buffers[1])[k];
+		end = ((const int32_t *)column.dictionary->buffers[1])[k + 1];
+	}
+	std::string name((const char *)column.dictionary->buffers[2] + begin, end - begin);
+	std::unordered_map<std::string, long long>::iterator it = dictionary_names.find(name);
+	if (it == dictionary_names.end())
+	{
+		long long id = AddName(edges, name.data(), name.size());
+		if (id == -1) return "cannot be read, memory allocation failed";
+		it = dictionary_names.insert(std::make_pair(name, id)).first;
+	}
+	column.vertex[value] = it->second;
+	return NULL;
+}
+
+/* Read the edges of a record batch whose first three columns are the sources, targets and weights;
+   returns NULL with a description in *error if the batch cannot be used */
+ArrowEdges *ArrowEdgesOpen(const ArrowArray *batch, const ArrowSchema *schema, const char **error)
+{
+	TRACE_SCOPE("ArrowEdgesOpen");
+	*error = NULL;
+	if (batch->release == NULL || schema->release == NULL) *error = "has already been released";
+	else if (strcmp(schema->format, "+s") || schema->n_children < 3 || batch->n_children != schema->n_children)
+		*error = "is not a record batch of source, target and weight columns";
+	if (*error != NULL) return NULL;
+
+	ArrowEdges *edges = new ArrowEdges();
+	edges->name_arena = ARENA_INIT;
+	edges->num_edges = batch->length;
+	const ArrowSchema *weight_type = schema->children[2];
+	const ArrowArray *weight = batch->children[2];
+	edges->weight_format = strlen(weight_type->format) == 1 ? weight_type->format[0] : 0;
+	int weight_width = edges->weight_format == 'f' || edges->weight_format == 'i' ? 4 : 8;
+	if (edges->weight_format == 0 || !strchr("fgil", edges->weight_format)) *error = "has weights that are not numbers";
+	else if (weight->n_buffers < 2 || HasNulls(weight, weight->offset + batch->offset, batch->length)) *error = "has missing weights";
+	else
+	{
+		edges->weight = (const char *)weight->buffers[1] + (weight->offset + batch->offset) * weight_width;
+		*error = OpenVertexColumn(batch, schema, 0, &edges->source);
+	}
+	if (*error == NULL) *error = OpenVertexColumn(batch, schema, 1, &edges->target);
+	if (*error == NULL && (edges->source.dictionary == NULL) != (edges->target.dictionary == NULL))
+		*error = "has one dictionary encoded and one integer vertex column";
+
+	std::unordered_map<std::string, long long> dictionary_names;
+	for (long long e = 0; e != edges->num_edges && *error == NULL; e++)
+	{
+		*error = NumberVertex(edges, edges->source, dictionary_names, e);
+		if (*error == NULL) *error = NumberVertex(edges, edges->target, dictionary_names, e);
+	}
+	if (*error != NULL)
+	{
+		ArrowEdgesFree(edges);
+		return NULL;
+	}
+	edges->num_vertices = (long long)edges->names.size();
+	return edges;
+}
+
+static long long Vertex(const ArrowEdges &edges, const ArrowVertexColumn &column, long long e)
+{
+	long long value = IntegerValue(column.values, column.width, e);
+	return column.dictionary == NULL ? edges.ids.find(value)->second : column.vertex[value];
+}
+
+/* Vertex ids and weights of the edges [begin, end) */
+void ArrowEdgesRead(const ArrowEdges &edges, long long begin, long long end, long long *source, long long *target, double *weight)
+{
+	for (long long e = begin; e != end; e++)
+	{
+		source[e - begin] = Vertex(edges, edges.source, e);
+		target[e - begin] = Vertex(edges, edges.target, e);
+		switch (edges.weight_format)
+		{
+		case 'f': weight[e - begin] = ((const float *)edges.weight)[e]; break;
+		case 'g': weight[e - begin] = ((const double *)edges.weight)[e]; break;
+		case 'i': weight[e - begin] = ((const int32_t *)edges.weight)[e]; break;
+		default: weight[e - begin] = (double)((const int64_t *)edges.weight)[e]; break;
+		}
+	}
+}
+
+/* Average vertex name length, estimated from the first names */
+double ArrowEdgesNameLength(const ArrowEdges &edges)
+{
+	long long n = edges.num_vertices < 10000 ? edges.num_vertices : 10000, length = 0;
+	for (long long k = 0; k != n; k++) length += strlen(edges.names[k]);
+	return n == 0 ? 0 : (double)length / n;
+}
+
+void ArrowEdgesFree(ArrowEdges *edges)
+{
+	if (edges == NULL) return;
+	ArenaRelease(&edges->name_arena);
+	delete edges;
+}
+
+// What an exported schema or array owns, freed by its release callback
+struct ExportedSchema {
+	std::string format, name;
+	std::vector<ArrowSchema *> children;
+};
+
+struct ExportedArray {
+	std::vector<const void *> buffers;
+	std::vector<ArrowArray *> children;
+	void *memory[2];
+};
+
+static void ReleaseSchema(ArrowSchema *schema)
+{
+	ExportedSchema *exported = (ExportedSchema *)schema->private_data;
+	for (size_t k = 0; k != exported->children.size(); k++)
+	{
+		if (exported->children[k]->release != NULL) exported->children[k]->release(exported->children[k]);
+		delete exported->children[k];
+	}
+	delete exported;
+	schema->release = NULL;
+}
+
+static void ReleaseArray(ArrowArray *array)
+{
+	ExportedArray *exported = (ExportedArray *)array->private_data;
+	for (size_t k = 0; k != exported->children.size(); k++)
+	{
+		if (exported->children[k]->release != NULL) exported->children[k]->release(exported->children[k]);
+		delete exported->children[k];
+	}
+	free(exported->memory[0]);
+	free(exported->memory[1]);
+	delete exported;
+	array->release = NULL;
+}
+
+static void ExportSchema(ArrowSchema *schema, const std::string &format, const std::string &name, int n_children)
+{
+	ExportedSchema *exported = new ExportedSchema();
+	exported->format = format;
+	exported->name = name;
+	for (int k = 0; k != n_children; k++) exported->children.push_back(new ArrowSchema());
+	schema->format = exported->format.c_str();
+	schema->name = exported->name.c_str();
+	schema->metadata = NULL;
+	schema->flags = 0;
+	schema->n_children = n_children;
+	schema->children = n_children > 0 ? &exported->children[0] : NULL;
+	schema->dictionary = NULL;
+	schema->release = ReleaseSchema;
+	schema->private_data = exported;
+}
+
+/* An array of length values in buffers that it owns, with no validity bitmap */
+static void ExportArray(ArrowArray *array, long long length, int n_buffers, void *memory_0, void *memory_1, int n_children)
+{
+	ExportedArray *exported = new ExportedArray();
+	exported->buffers.push_back(NULL);
+	if (n_buffers > 1) exported->buffers.push_back(memory_0);
+	if (n_buffers > 2) exported->buffers.push_back(memory_1);
+	exported->memory[0] = memory_0;
+	exported->memory[1] = memory_1;
+	for (int k = 0; k != n_children; k++) exported->children.push_back(new ArrowArray());
+	array->length = length;
+	array->null_count = 0;
+	array->offset = 0;
+	array->n_buffers = n_buffers;
+	array->n_children = n_children;
+	array->buffers = &exported->buffers[0];
+	array->children = n_children > 0 ? &exported->children[0] : NULL;
+	array->dictionary = NULL;
+	array->release = ReleaseArray;
+	array->private_data = exported;
+}
+
+/* Export the rows of vectors as a fixed size list column; returns 0 if out of memory */
+static int ExportRows(const std::vector< std::vector<double> > &vectors, ArrowArray *array, ArrowSchema *schema, const char *name)
+{
+	long long rows = (long long)vectors.size(), dim = (long long)vectors[0].size();
+	double *values = (double *)malloc(rows * dim * sizeof(double) + 1);
+	if (values == NULL) return 0;
+	for (long long r = 0; r != rows; r++) memcpy(values + r * dim, &vectors[r][0], dim * sizeof(double));
+	ExportSchema(schema, "+w:" + std::to_string(dim), name, 1);
+	ExportSchema(schema->children[0], "g", "item", 0);
+	ExportArray(array, rows, 1, NULL, NULL, 1);
+	ExportArray(array->children[0], rows * dim, 2, values, NULL, 0);
+	return 1;
+}
+
+/* Export an embedding, and its context embedding unless that is empty, as a record batch of the
+   columns vertex, embedding and context into array and schema; returns 0 if out of memory */
+int ArrowExportEmbedding(const std::vector<std::string> &vertices, const std::vector< std::vector<double> > &vectors,
+                         const std::vector< std::vector<double> > &context, ArrowArray *array, ArrowSchema *schema)
+{
+	TRACE_SCOPE("ArrowExportEmbedding");
+	long long rows = (long long)vertices.size(), name_bytes = 0;
+	if (rows == 0) return 0;
+	for (long long r = 0; r != rows; r++) name_bytes += vertices[r].size();
+	// 32-bit offsets as long as the names fit, which is what most readers expect
+	int large = name_bytes > INT_MAX;
+	void *offsets = malloc((rows + 1) * (large ? sizeof(int64_t) : sizeof(int32_t)));
+	char *names = (char *)malloc(name_bytes + 1);
+	if (offsets == NULL || names == NULL)
+	{
+		free(offsets);
+		free(names);
+		return 0;
+	}
+	long long position = 0;
+	for (long long r = 0; r <= rows; r++)
+	{
+		if (large) ((int64_t *)offsets)[r] = position;
+		else ((int32_t *)offsets)[r] = (int32_t)position;
+		if (r == rows) break;
+		memcpy(names + position, vertices[r].data(), vertices[r].size());
+		position += vertices[r].size();
+	}
+
+	int columns = context.empty() ? 2 : 3;
+	ExportSchema(schema, "+s", "", columns);
+	ExportSchema(schema->children[0], large ? "U" : "u", "vertex", 0);
+	ExportArray(array, rows, 1, NULL, NULL, columns);
+	ExportArray(array->children[0], rows, 3, offsets, names, 0);
+	if (!ExportRows(vectors, array->children[1], schema->children[1], "embedding") ||
+	    (columns == 3 && !ExportRows(context, array->children[2], schema->children[2], "context")))
+	{
+		array->release(array);
+		schema->release(schema);
+		return 0;
+	}
+	return 1;
+}
@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "arena.h"
+
+#ifndef ARROW_DATA_H
+#define ARROW_DATA_H
+
+// The structs of the Arrow C Data Interface, declared as its specification asks producers and
+// consumers to, so that no Arrow library is needed to exchange data with one
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+	const char *format;
+	const char *name;
+	const char *metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema **children;
+	struct ArrowSchema *dictionary;
+	void (*release)(struct ArrowSchema *);
+	void *private_data;
+};
+
+struct ArrowArray {
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void **buffers;
+	struct ArrowArray **children;
+	struct ArrowArray *dictionary;
+	void (*release)(struct ArrowArray *);
+	void *private_data;
+};
+#endif
+
+// An array and its schema, for an Arrow library to export into or to import from
+struct ArrowStructs {
+	ArrowArray array;
+	ArrowSchema schema;
+};
+
+// One vertex column of an edge batch
+struct ArrowVertexColumn {
+	const void *values;                    // dictionary indices, or the vertex ids themselves
+	int width;                             // bytes of a value
+	const ArrowArray *dictionary;          // strings of the indices, NULL for integer ids
+	int large;                             // the dictionary has 64-bit offsets
+	std::vector<long long> vertex;         // vertex of every dictionary entry
+};
+
+// The edges of an Arrow record batch of source, target and weight columns, read in place. The
+// vertices are numbered by their first appearance, as line numbers the vertices of a data frame.
+struct ArrowEdges {
+	long long num_vertices, num_edges;
+	std::vector<const char *> names;       // in name_arena
+	ArrowVertexColumn source, target;
+	const void *weight;
+	char weight_format;                    // Arrow format of the weights: f, g, i or l
+	std::unordered_map<long long, long long> ids;   // vertex of every integer id
+	Arena name_arena;
+};
+
+void ArrowStructsFree(ArrowStructs *structs);
+ArrowEdges *ArrowEdgesOpen(const ArrowArray *batch, const ArrowSchema *schema, const char **error);
+void ArrowEdgesRead(const ArrowEdges &edges, long long begin, long long end, long long *source, long long *target, double *weight);
+double ArrowEdgesNameLength(const ArrowEdges &edges);
+void ArrowEdgesFree(ArrowEdges *edges);
+int ArrowExportEmbedding(const std::vector<std::string> &vertices, const std::vector< std::vector<double> > &vectors,
+                         const std::vector< std::vector<double> > &context, ArrowArray *array, ArrowSchema *schema);
+#endif
@@ -0,0 +1,246 @@
+/*
+Microbenchmark of the LINE Update kernel.
+
+Runs the same Update + FastSigmoid sequence as TrainLINEThread (one positive and num_negative
+negative updates per sampled edge) over embedding matrices of a given working set size, and
+compares the achieved GFLOP/s and GB/s with the measured peaks of the machine so that each
+configuration can be placed on a roofline. The floating point peak is measured with the vector
+instructions of simd.h, fused multiply-adds included when the compiler targets them, so it does
+not depend on the compiler vectorizing a loop; it is the peak of the instruction set the package
+was compiled for. The matrices are allocated like the trainer's, with
+or without huge pages, and the dTLB misses of the kernel are counted to show what they change.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <vector>
+#include <string>
+#include "line_kernel.h"
+#include "huge_pages.h"
+#include "perf_counters.h"
+#include "simd.h"
+#include "benchmark.h"
+
+#define PEAK_REPEATS 5
+
+static const long long stream_size = 16 * 1024 * 1024;
+static const long long flops_iterations = 20000000;
+static const int flops_chains = 12;    // independent multiply-adds in flight, enough to cover their latency on two ports
+
+#if defined(__AVX__) && defined(__FMA__)
+#define PEAK_SIMD_NAME "avx fma"
+#else
+#define PEAK_SIMD_NAME SIMD_NAME
+#endif
+
+static int dim = 100, num_negative = 5, num_threads = 1;
+static long long row_stride = 112;     // floats between rows, padded like the trainer's
+static long long num_rows = 0, total_samples = 0;
+static real rho = 0.025;
+static real *emb_vertex, *emb_context, *sigmoid_table;
+static float *stream_a, *stream_b, *stream_c;
+static volatile float flops_sink;
+
+static double NowSeconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double RunThreads(void *(*fn)(void *))
+{
+	pthread_t *pt = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+	double start = NowSeconds();
+	for (long a = 0; a < num_threads; a++) pthread_create(&pt[a], NULL, fn, (void *)a);
+	for (long a = 0; a < num_threads; a++) pthread_join(pt[a], NULL);
+	double seconds = NowSeconds() - start;
+	free(pt);
+	return seconds;
+}
+
+/* STREAM triad over arrays much larger than the last level cache */
+static void *TriadThread(void *id)
+{
+	long long chunk = stream_size / num_threads;
+	long long begin = (long long)id * chunk;
+	long long end = (long long)id == num_threads - 1 ? stream_size : begin + chunk;
+	for (long long k = begin; k != end; k++) stream_a[k] = stream_b[k] + 3.0f * stream_c[k];
+	return NULL;
+}
+
+// One multiply-add of every chain, written out so that the accumulators stay in registers
+#define FLOPS_STEP(MADD) \
+	a0 = MADD(a0); a1 = MADD(a1); a2 = MADD(a2); a3 = MADD(a3); a4 = MADD(a4); a5 = MADD(a5); \
+	a6 = MADD(a6); a7 = MADD(a7); a8 = MADD(a8); a9 = MADD(a9); a10 = MADD(a10); a11 = MADD(a11)
+
+/* flops_chains independent multiply-add chains of SIMD_FLOATS lanes each */
+static void *FlopsThread(void *id)
+{
+	float mul = 0.999999f, add = 1e-7f * ((long long)id + 1), lanes[SIMD_FLOATS], sum = 0;
+#if defined(__AVX__)
+	__m256 m = _mm256_set1_ps(mul), b = _mm256_set1_ps(add);
+	__m256 a0 = _mm256_set1_ps(0), a1 = _mm256_set1_ps(1), a2 = _mm256_set1_ps(2), a3 = _mm256_set1_ps(3), a4 = _mm256_set1_ps(4),
+		a5 = _mm256_set1_ps(5), a6 = _mm256_set1_ps(6), a7 = _mm256_set1_ps(7), a8 = _mm256_set1_ps(8), a9 = _mm256_set1_ps(9),
+		a10 = _mm256_set1_ps(10), a11 = _mm256_set1_ps(11);
+#if defined(__FMA__)
+#define MADD(a) _mm256_fmadd_ps(a, m, b)
+#else
+#define MADD(a) _mm256_add_ps(_mm256_mul_ps(a, m), b)
+#endif
+	for (long long it = 0; it != flops_iterations; it++) { FLOPS_STEP(MADD); }
+#undef MADD
+	a0 = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3)), _mm256_add_ps(_mm256_add_ps(a4, a5), _mm256_add_ps(a6, a7)));
+	_mm256_storeu_ps(lanes, _mm256_add_ps(a0, _mm256_add_ps(_mm256_add_ps(a8, a9), _mm256_add_ps(a10, a11))));
+#elif defined(__SSE2__)
+	__m128 m = _mm_set1_ps(mul), b = _mm_set1_ps(add);
+	__m128 a0 = _mm_set1_ps(0), a1 = _mm_set1_ps(1), a2 = _mm_set1_ps(2), a3 = _mm_set1_ps(3), a4 = _mm_set1_ps(4),
+		a5 = _mm_set1_ps(5), a6 = _mm_set1_ps(6), a7 = _mm_set1_ps(7), a8 = _mm_set1_ps(8), a9 = _mm_set1_ps(9),
+		a10 = _mm_set1_ps(10), a11 = _mm_set1_ps(11);
+#define MADD(a) _mm_add_ps(_mm_mul_ps(a, m), b)
+	for (long long it = 0; it != flops_iterations; it++) { FLOPS_STEP(MADD); }
+#undef MADD
+	a0 = _mm_add_ps(_mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3)), _mm_add_ps(_mm_add_ps(a4, a5), _mm_add_ps(a6, a7)));
+	_mm_storeu_ps(lanes, _mm_add_ps(a0, _mm_add_ps(_mm_add_ps(a8, a9), _mm_add_ps(a10, a11))));
+#else
+	float a0 = 0, a1 = 1, a2 = 2, a3 = 3, a4 = 4, a5 = 5, a6 = 6, a7 = 7, a8 = 8, a9 = 9, a10 = 10, a11 = 11;
+#define MADD(a) ((a) * mul + add)
+	for (long long it = 0; it != flops_iterations; it++) { FLOPS_STEP(MADD); }
+#undef MADD
+	lanes[0] = a0 + a1 + a2 + a3 + a4 + a5 + a6 + a7 + a8 + a9 + a10 + a11;
+#endif
+	for (int l = 0; l != SIMD_FLOATS; l++) sum += lanes[l];
+	flops_sink = sum;
+	return NULL;
+}
+
+static void MeasurePeaks(double &peak_gflops, double &peak_gbs)
+{
+	double best;
+
+	stream_a = (float *)malloc(stream_size * sizeof(float));
+	stream_b = (float *)malloc(stream_size * sizeof(float));
+	stream_c = (float *)malloc(stream_size * sizeof(float));
+	for (long long k = 0; k != stream_size; k++) { stream_a[k] = 0; stream_b[k] = 1; stream_c[k] = 2; }
+	best = 1e30;
+	for (int r = 0; r != PEAK_REPEATS; r++)
+	{
+		double seconds = RunThreads(TriadThread);
+		if (seconds < best) best = seconds;
+	}
+	peak_gbs = 3.0 * stream_size * sizeof(float) / best / 1e9;
+	free(stream_a);
+	free(stream_b);
+	free(stream_c);
+
+	best = 1e30;
+	for (int r = 0; r != PEAK_REPEATS; r++)
+	{
+		double seconds = RunThreads(FlopsThread);
+		if (seconds < best) best = seconds;
+	}
+	peak_gflops = 2.0 * flops_chains * SIMD_FLOATS * flops_iterations * num_threads / best / 1e9;
+}
+
+static void *UpdateThread(void *id)
+{
+	long long u, lu, lv, target, label;
+	unsigned long long seed = (long long)id * 7919 + 1;
+	real *vec_error = (real *)calloc(dim, sizeof(real));
+
+	for (long long count = 0; count < total_samples / num_threads; count++)
+	{
+		seed = seed * 25214903917 + 11;
+		u = (seed >> 16) % num_rows;
+		lu = u * row_stride;
+		for (int c = 0; c != dim; c++) vec_error[c] = 0;
+		for (int d = 0; d != num_negative + 1; d++)
+		{
+			seed = seed * 25214903917 + 11;
+			target = (seed >> 16) % num_rows;
+			label = d == 0;
+			lv = target * row_stride;
+			Update(&emb_vertex[lu], &emb_context[lv], vec_error, label, dim, rho, sigmoid_table);
+		}
+		for (int c = 0; c != dim; c++) emb_vertex[c + lu] += vec_error[c];
+	}
+	free(vec_error);
+	return NULL;
+}
+
+static int BenchmarkUpdate(int dim_param, double working_set_mb, int huge, UpdateBenchmarkResult &result)
+{
+	int vertex_kind, context_kind;
+	dim = dim_param;
+	row_stride = PaddedRowStride(dim);
+	num_rows = (long long)(working_set_mb * 1024 * 1024 / (2.0 * row_stride * sizeof(real)));
+	if (num_rows < num_negative + 2) num_rows = num_negative + 2;
+
+	emb_vertex = (real *)HugeAlloc(num_rows * row_stride * sizeof(real), huge, &vertex_kind);
+	emb_context = (real *)HugeAlloc(num_rows * row_stride * sizeof(real), huge, &context_kind);
+	if (emb_vertex == NULL || emb_context == NULL) { HugeFree(emb_vertex); HugeFree(emb_context); return 0; }
+	for (long long k = 0; k != num_rows * row_stride; k++)
+	{
+		emb_vertex[k] = k % row_stride < dim ? ((k * 2654435761LL) % 1000 / 1000.0 - 0.5) / dim : 0;
+		emb_context[k] = 0;
+	}
+
+	// Count the dTLB misses of the kernel even when perf_counters is off, without printing them
+	int perf_was_enabled = PerfEnabled();
+	PerfCounters pc;
+	PerfEnable(1);
+	PerfStart(&pc, "benchmark update");
+	double seconds = RunThreads(UpdateThread);
+	PerfStop(&pc);
+	PerfEnable(perf_was_enabled);
+	double samples = (double)(total_samples / num_threads) * num_threads;
+	long long dtlb_misses = PerfReport().back().values[PERF_DTLB_MISSES];
+
+	result.dim = dim;
+	result.rows = num_rows;
+	result.working_set_mb = 2.0 * num_rows * row_stride * sizeof(real) / 1024 / 1024;
+	result.seconds = seconds;
+	result.gflops = samples * UpdateSampleFlops(dim, num_negative) / seconds / 1e9;
+	result.gbs = samples * UpdateSampleBytes(dim, num_negative) / seconds / 1e9;
+	result.intensity = UpdateSampleFlops(dim, num_negative) / UpdateSampleBytes(dim, num_negative);
+	result.dtlb_misses = dtlb_misses < 0 ? NAN : dtlb_misses / samples;
+	result.pages = huge_page_kind_names[vertex_kind < context_kind ? vertex_kind : context_kind];
+
+	HugeFree(emb_vertex);
+	HugeFree(emb_context);
+	return 1;
+}
+
+void BenchmarkUpdateMain(const std::vector<int> &dims, const std::vector<double> &working_set_mb, const std::vector<int> &huge_pages,
+					double samples_param, int num_negative_param, int num_threads_param, std::vector<UpdateBenchmarkResult> &results)
+{
+	PerfReset();
+	double peak_gflops, peak_gbs;
+
+	num_negative = num_negative_param;
+	num_threads = num_threads_param < 1 ? 1 : num_threads_param;
+	total_samples = (long long)(samples_param * 1000000);
+	if (total_samples < num_threads) total_samples = num_threads;
+
+	sigmoid_table = (real *)malloc((sigmoid_table_size + 1) * sizeof(real));
+	InitSigmoidTable(sigmoid_table);
+	MeasurePeaks(peak_gflops, peak_gbs);
+
+	for (size_t d = 0; d != dims.size(); d++) for (size_t w = 0; w != working_set_mb.size(); w++) for (size_t h = 0; h != huge_pages.size(); h++)
+	{
+		UpdateBenchmarkResult result;
+		if (!BenchmarkUpdate(dims[d], working_set_mb[w], huge_pages[h], result)) continue;
+		result.peak_gflops = peak_gflops;
+		result.peak_gbs = peak_gbs;
+		result.roof_gflops = result.intensity * peak_gbs < peak_gflops ? result.intensity * peak_gbs : peak_gflops;
+		result.bound = result.intensity * peak_gbs < peak_gflops ? "memory" : "compute";
+		result.simd = PEAK_SIMD_NAME;
+		result.simd_floats = SIMD_FLOATS;
+		results.push_back(result);
+	}
+	free(sigmoid_table);
+}
@@ -0,0 +1,19 @@
+#include <vector>
+#include <string>
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+struct UpdateBenchmarkResult {
+	int dim;
+	long long rows;
+	double working_set_mb, seconds, gflops, gbs, intensity, peak_gflops, peak_gbs, roof_gflops;
+	double dtlb_misses;                    // per sampled edge, NaN when the counter is not available
+	std::string bound, pages;
+	std::string simd;                      // instruction set peak_gflops was measured with
+	int simd_floats;                       // floats per vector of that instruction set
+};
+
+void BenchmarkUpdateMain(const std::vector<int> &dims, const std::vector<double> &working_set_mb, const std::vector<int> &huge_pages,
+					double samples_param, int num_negative_param, int num_threads_param, std::vector<UpdateBenchmarkResult> &results);
+#endif
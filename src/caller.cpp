@@ -3,22 +3,152 @@
 #include <vector>
 #include <stdio.h>
 #include <cassert> 
+#include <climits>
 #include "reconstruct_vector.h"
 #include "line_vector.h"
 #include "concatenate_vector.h"
+#include "normalize_vector.h"
+#include "benchmark.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "memory_planner.h"
+#include "hnsw.h"
+#include "similarity.h"
+#include "link_prediction.h"
+#include "fold_in.h"
+#include "walk.h"
+#include "pte.h"
+#include "compressed_graph.h"
+#include "graph_store.h"
+#include "edge_file.h"
+#include "arrow_data.h"
+
+// The p, i and x slots of a square dgCMatrix adjacency matrix as a compressed graph, which borrows the i and x
+// slots and the names; col_ptr holds the column pointers widened to 64 bits and vertex_names pointers into R's
+// string cache
+static CompressedGraph SlotsGraph(const char *function, Rcpp::IntegerVector p, Rcpp::IntegerVector i, Rcpp::NumericVector x,
+                                  Rcpp::StringVector names, std::vector<long long> &col_ptr, std::vector<const char *> &vertex_names) {
+  R_xlen_t n = names.size(), nnz = i.size();
+  if (p.size() != n + 1 || p[0] != 0 || p[n] != nnz || x.size() != nnz)
+    Rcpp::stop("%s: the slots of the adjacency matrix do not describe a %d x %d dgCMatrix", function, (int) n, (int) n);
+  for (R_xlen_t j = 0; j < n; j++)
+    if (p[j + 1] < p[j]) Rcpp::stop("%s: the column pointers of the adjacency matrix decrease", function);
+  for (R_xlen_t e = 0; e < nnz; e++)
+    if (i[e] < 0 || i[e] >= n) Rcpp::stop("%s: row index %d of the adjacency matrix is out of range", function, i[e]);
+  col_ptr.assign(p.begin(), p.end());
+  vertex_names.resize(n);
+  for (R_xlen_t k = 0; k < n; k++) vertex_names[k] = CHAR(STRING_ELT(names, k));
+  CompressedGraph graph = { (long long) n, (long long) nnz, col_ptr.data(), i.begin(), x.begin(), vertex_names.data() };
+  return graph;
+}
+
+typedef Rcpp::XPtr<GraphStore, Rcpp::PreserveStorage, GraphFree> GraphPointer;
+
+static GraphStore *GraphFromPointer(SEXP graph) {
+  GraphPointer pointer(graph);
+  if (pointer.get() == NULL) Rcpp::stop("the graph is no longer valid, build it again with rline_graph");
+  return pointer.get();
+}
 
 // [[Rcpp::export]]
-Rcpp::DataFrame reconstruct_caller(Rcpp::StringVector input_u, Rcpp::StringVector input_v, Rcpp::NumericVector input_w, int max_depth = 1, int max_k = 0) {
-  std::vector<std::string> iu(input_u.size()), iv(input_v.size()), ou, ov;
-  std::vector<double> iw(input_w.size()), ow;
-  for (long long i = 0; i < input_u.size(); i++) {
-    iu[i] = (std::string) input_u(i);
-    iv[i] = (std::string) input_v(i);
-    iw[i] = (double) input_w(i);
+SEXP rline_graph_caller(Rcpp::StringVector input_u, Rcpp::StringVector input_v, Rcpp::NumericVector input_w) {
+  std::vector<const char *> source(input_u.size()), target(input_v.size());
+  for (R_xlen_t i = 0; i < input_u.size(); i++) {
+    source[i] = CHAR(STRING_ELT(input_u, i));
+    target[i] = CHAR(STRING_ELT(input_v, i));
   }
-  
-  ReconstructMain(iu, iv, iw, ou, ov, ow, max_depth, max_k);
+  GraphStore *store = GraphBuild(source.data(), target.data(), input_w.begin(), (long long) input_u.size());
+  if (store == NULL) Rcpp::stop("rline_graph: memory allocation failed, or the graph has more than %d vertices", INT_MAX);
+  return GraphPointer(store, true);
+}
+
+// [[Rcpp::export]]
+bool rline_graph_save_caller(SEXP graph, std::string file, bool alias = true) {
+  if (!GraphSave(GraphFromPointer(graph), file.c_str(), alias)) Rcpp::stop("rline_graph_save: cannot write %s", file);
+  return true;
+}
+
+// [[Rcpp::export]]
+SEXP rline_graph_load_caller(std::string file, bool verify = true) {
+  const char *error;
+  GraphStore *store = GraphLoad(file.c_str(), verify, &error);
+  if (store == NULL) Rcpp::stop("rline_graph_load: %s %s", file, error);
+  return GraphPointer(store, true);
+}
+
+// [[Rcpp::export]]
+Rcpp::List graph_info_caller(SEXP graph) {
+  GraphStore *store = GraphFromPointer(graph);
+  return Rcpp::List::create(Rcpp::Named("vertices") = (double) store->graph.num_vertices,
+                            Rcpp::Named("edges") = (double) store->graph.num_edges,
+                            Rcpp::Named("name_bytes") = (double) store->name_arena.bytes,
+                            Rcpp::Named("mapped") = store->mapping != NULL);
+}
+
+// [[Rcpp::export]]
+Rcpp::StringVector graph_vertices_caller(SEXP graph) {
+  GraphStore *store = GraphFromPointer(graph);
+  Rcpp::StringVector names(store->graph.num_vertices);
+  for (R_xlen_t k = 0; k < names.size(); k++) names[k] = store->graph.names[k];
+  return names;
+}
+
+typedef Rcpp::XPtr<EdgeFile, Rcpp::PreserveStorage, EdgeFileClose> EdgeFilePointer;
+
+static EdgeFile *EdgeFileFromPointer(SEXP edges) {
+  EdgeFilePointer pointer(edges);
+  if (pointer.get() == NULL) Rcpp::stop("the edge file is no longer open, open it again with rline_edges");
+  return pointer.get();
+}
 
+// [[Rcpp::export]]
+SEXP rline_edges_caller(std::string file) {
+  const char *error;
+  EdgeFile *edge_file = EdgeFileOpen(file.c_str(), &error);
+  if (edge_file == NULL) Rcpp::stop("rline_edges: %s %s", file, error);
+  return EdgeFilePointer(edge_file, true);
+}
+
+// [[Rcpp::export]]
+bool rline_edges_convert_caller(std::string text_file, std::string binary_file) {
+  const char *error;
+  if (!ConvertEdgeListMain(text_file.c_str(), binary_file.c_str(), &error)) Rcpp::stop("rline_edges_convert: %s", error);
+  return true;
+}
+
+// [[Rcpp::export]]
+Rcpp::List edges_info_caller(SEXP edges) {
+  EdgeFile *edge_file = EdgeFileFromPointer(edges);
+  return Rcpp::List::create(Rcpp::Named("vertices") = (double) edge_file->num_vertices,
+                            Rcpp::Named("edges") = (double) edge_file->num_edges,
+                            Rcpp::Named("file_bytes") = (double) edge_file->mapping_bytes);
+}
+
+typedef Rcpp::XPtr<ArrowStructs, Rcpp::PreserveStorage, ArrowStructsFree> ArrowPointer;
+
+// [[Rcpp::export]]
+SEXP arrow_structs_caller() {
+  ArrowStructs *structs = (ArrowStructs *) calloc(1, sizeof(ArrowStructs));
+  if (structs == NULL) Rcpp::stop("memory allocation failed");
+  return ArrowPointer(structs, true);
+}
+
+// [[Rcpp::export]]
+Rcpp::NumericVector arrow_addresses_caller(SEXP structs) {
+  ArrowStructs *pointer = ArrowPointer(structs).get();
+  return Rcpp::NumericVector::create((double) (uintptr_t) &pointer->array, (double) (uintptr_t) &pointer->schema);
+}
+
+// The edges of the record batch an Arrow library exported into structs; stops if they cannot be read
+static ArrowEdges *ArrowEdgesFromPointer(const char *function, SEXP structs) {
+  ArrowStructs *pointer = ArrowPointer(structs).get();
+  const char *error;
+  ArrowEdges *edges = ArrowEdgesOpen(&pointer->array, &pointer->schema, &error);
+  if (edges == NULL) Rcpp::stop("%s: the Arrow record batch %s", function, error);
+  return edges;
+}
+
+static Rcpp::DataFrame EdgeFrame(const std::vector<std::string> &ou, const std::vector<std::string> &ov, const std::vector<double> &ow) {
   Rcpp::StringVector output_u(ou.size()), output_v(ov.size());
   Rcpp::NumericVector output_w(ow.size());
   output_u = ou; output_v = ov; output_w = Rcpp::wrap(ow);
@@ -26,67 +156,580 @@ Rcpp::DataFrame reconstruct_caller(Rcpp::StringVector input_u, Rcpp::StringVecto
 }
 
 // [[Rcpp::export]]
-Rcpp::NumericMatrix line_caller(Rcpp::StringVector input_u, Rcpp::StringVector input_v, Rcpp::NumericVector input_w, int binary = 0, int dim = 100, int order = 2, int negative = 5, int samples = 1, float rho = 0.025, int threads = 1) {
-  std::vector<std::string> iu(input_u.size()), iv(input_v.size()), output_vertices;
-  std::vector<double> iw(input_w.size());
-  std::vector< std::vector<double> > output_features;
-  for (long long i = 0; i < input_u.size(); i++) {
-    iu[i] = (std::string) input_u(i);
-    iv[i] = (std::string) input_v(i);
-    iw[i] = (double) input_w(i);
+Rcpp::DataFrame reconstruct_caller(Rcpp::StringVector input_u, Rcpp::StringVector input_v, Rcpp::NumericVector input_w, int max_depth = 1, int max_k = 0) {
+  std::vector<std::string> iu(input_u.size()), iv(input_v.size()), ou, ov;
+  std::vector<double> iw(input_w.size()), ow;
+  {
+    TRACE_SCOPE("reconstruct_caller input conversion");
+    for (R_xlen_t i = 0; i < input_u.size(); i++) {
+      iu[i] = (std::string) input_u(i);
+      iv[i] = (std::string) input_v(i);
+      iw[i] = (double) input_w(i);
+    }
   }
+  
+  ReconstructMain(iu, iv, iw, ou, ov, ow, max_depth, max_k);
 
-  TrainLINEMain(iu, iv, iw, output_vertices, output_features, binary, dim, order, negative, samples, rho, threads);
+  TRACE_SCOPE("reconstruct_caller output conversion");
+  return EdgeFrame(ou, ov, ow);
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame reconstruct_store_caller(SEXP graph, int max_depth = 1, int max_k = 0) {
+  std::vector<std::string> ou, ov;
+  std::vector<double> ow;
+  ReconstructGraphMain(GraphFromPointer(graph)->graph, ou, ov, ow, max_depth, max_k);
+
+  TRACE_SCOPE("reconstruct_store_caller output conversion");
+  return EdgeFrame(ou, ov, ow);
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame reconstruct_arrow_caller(SEXP batch, int max_depth = 1, int max_k = 0) {
+  ArrowEdges *edges = ArrowEdgesFromPointer("reconstruct", batch);
+  std::vector<std::string> ou, ov;
+  std::vector<double> ow;
+  ReconstructArrowMain(*edges, ou, ov, ow, max_depth, max_k);
+  ArrowEdgesFree(edges);
+
+  TRACE_SCOPE("reconstruct_arrow_caller output conversion");
+  return EdgeFrame(ou, ov, ow);
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame reconstruct_edges_caller(SEXP edges, int max_depth = 1, int max_k = 0) {
+  std::vector<std::string> ou, ov;
+  std::vector<double> ow;
+  ReconstructEdgeFileMain(*EdgeFileFromPointer(edges), ou, ov, ow, max_depth, max_k);
+
+  TRACE_SCOPE("reconstruct_edges_caller output conversion");
+  return EdgeFrame(ou, ov, ow);
+}
 
-  long long row = (long long) output_features.size();
+// [[Rcpp::export]]
+Rcpp::DataFrame reconstruct_graph_caller(Rcpp::IntegerVector p, Rcpp::IntegerVector i, Rcpp::NumericVector x, Rcpp::StringVector names, int max_depth = 1, int max_k = 0) {
+  std::vector<long long> col_ptr;
+  std::vector<const char *> vertex_names;
+  CompressedGraph graph = SlotsGraph("reconstruct", p, i, x, names, col_ptr, vertex_names);
+  std::vector<std::string> ou, ov;
+  std::vector<double> ow;
+  ReconstructGraphMain(graph, ou, ov, ow, max_depth, max_k);
+
+  TRACE_SCOPE("reconstruct_graph_caller output conversion");
+  return EdgeFrame(ou, ov, ow);
+}
+
+static Rcpp::NumericMatrix LineMatrix(const std::vector<std::string> &output_vertices, const std::vector< std::vector<double> > &output_features,
+                                      const std::vector< std::vector<double> > &output_context) {
+  R_xlen_t row = (R_xlen_t) output_features.size();
   if (row == 0) {
       Rprintf("Error occured in line");
       return R_NilValue;
   }
-  long long col = (long long) output_features[0].size();
+  if (row > INT_MAX) Rcpp::stop("line: %lld vertices do not fit in the rows of an R matrix", (long long) row);
+  R_xlen_t col = (R_xlen_t) output_features[0].size();
   Rcpp::NumericMatrix feature_matrix(row, col);
   Rcpp::StringVector vertice_names(row);
   vertice_names = output_vertices;
   Rcpp::rownames(feature_matrix) = vertice_names;
-  for (long long r = 0; r < row; r++) {
-      for (long long c = 0; c < col; c++) {
+  for (R_xlen_t r = 0; r < row; r++) {
+      for (R_xlen_t c = 0; c < col; c++) {
         feature_matrix(r, c) = output_features[r][c];
       }
   }
+  if (!output_context.empty()) {
+    Rcpp::NumericMatrix context_matrix(row, col);
+    Rcpp::rownames(context_matrix) = vertice_names;
+    for (R_xlen_t r = 0; r < row; r++) {
+      for (R_xlen_t c = 0; c < col; c++) {
+        context_matrix(r, c) = output_context[r][c];
+      }
+    }
+    feature_matrix.attr("context") = context_matrix;
+  }
   return feature_matrix;
 }
 
-// [[Rcpp::export]]
-Rcpp::NumericMatrix concatenate_caller(Rcpp::NumericMatrix input_one, Rcpp::NumericMatrix input_two, Rcpp::StringVector first_order_v, Rcpp::StringVector second_order_v, int binary = 0) {
-  long long first_order_rows = (long long) input_one.nrow(), second_order_rows = (long long) input_two.nrow();
-  std::vector<std::string> first_order_vertices(first_order_rows), second_order_vertices(second_order_rows), output_vertices;
-  std::vector< std::vector<double> > first_order_features, second_order_features, output_features;
+// The embedding as an R matrix, or exported into the Arrow structs arrow_output, which are then returned
+static SEXP LineOutput(const std::vector<std::string> &output_vertices, const std::vector< std::vector<double> > &output_features,
+                       const std::vector< std::vector<double> > &output_context, SEXP arrow_output) {
+  if (Rf_isNull(arrow_output)) return LineMatrix(output_vertices, output_features, output_context);
+  if (output_features.empty()) {
+      Rprintf("Error occured in line");
+      return R_NilValue;
+  }
+  ArrowStructs *structs = ArrowPointer(arrow_output).get();
+  if (structs->array.release != NULL) structs->array.release(&structs->array);
+  if (structs->schema.release != NULL) structs->schema.release(&structs->schema);
+  if (!ArrowExportEmbedding(output_vertices, output_features, output_context, &structs->array, &structs->schema))
+    Rcpp::stop("line: memory allocation failed while exporting the embedding");
+  return arrow_output;
+}
 
-  for (long long i = 0; i < (long long) first_order_rows; i++) {
-    first_order_vertices[i] = (std::string) first_order_v[i];
-    Rcpp::NumericVector current_row = input_one.row(i);
-    std::vector<double> v(current_row.begin(), current_row.end());
-    first_order_features.push_back(v);
+// [[Rcpp::export]]
+SEXP line_caller(Rcpp::StringVector input_u, Rcpp::StringVector input_v, Rcpp::NumericVector input_w, int binary = 0, int dim = 100, int order = 2, int negative = 5, int samples = 1, float rho = 0.025, int threads = 1, double memory_budget = 0, bool context = false, double hub_vertices = 0, bool huge_pages = true, SEXP arrow_output = R_NilValue) {
+  if (hub_vertices < 0 || hub_vertices > INT_MAX / 2) Rcpp::stop("line: hub_vertices must be between 0 and %d", INT_MAX / 2);
+  std::vector<std::string> iu(input_u.size()), iv(input_v.size()), output_vertices;
+  std::vector<double> iw(input_w.size());
+  std::vector< std::vector<double> > output_features, output_context;
+  {
+    TRACE_SCOPE("line_caller input conversion");
+    for (R_xlen_t i = 0; i < input_u.size(); i++) {
+      iu[i] = (std::string) input_u(i);
+      iv[i] = (std::string) input_v(i);
+      iw[i] = (double) input_w(i);
+    }
   }
-  for (long long i = 0; i < (long long) second_order_rows; i++) {
-    second_order_vertices[i] = (std::string) second_order_v[i];
-    Rcpp::NumericVector current_row = input_two.row(i);
-    std::vector<double> v(current_row.begin(), current_row.end());
-    second_order_features.push_back(v);
+
+  TrainLINEMain(iu, iv, iw, output_vertices, output_features, binary, dim, order, negative, samples, rho, threads, (long long) (memory_budget * 1048576),
+                context ? &output_context : NULL, (long long) hub_vertices, huge_pages);
+
+  TRACE_SCOPE("line_caller output conversion");
+  return LineOutput(output_vertices, output_features, output_context, arrow_output);
+}
+
+// [[Rcpp::export]]
+SEXP line_store_caller(SEXP graph, int binary = 0, int dim = 100, int order = 2, int negative = 5, int samples = 1, float rho = 0.025, int threads = 1, double memory_budget = 0, bool context = false, double hub_vertices = 0, bool huge_pages = true, SEXP arrow_output = R_NilValue) {
+  if (hub_vertices < 0 || hub_vertices > INT_MAX / 2) Rcpp::stop("line: hub_vertices must be between 0 and %d", INT_MAX / 2);
+  const CompressedGraph &input = GraphFromPointer(graph)->graph;
+  std::vector<std::string> output_vertices;
+  std::vector< std::vector<double> > output_features, output_context;
+
+  TrainLINEGraphMain(input, output_vertices, output_features, binary, dim, order, negative, samples, rho, threads, (long long) (memory_budget * 1048576),
+                     context ? &output_context : NULL, (long long) hub_vertices, huge_pages);
+
+  TRACE_SCOPE("line_store_caller output conversion");
+  return LineOutput(output_vertices, output_features, output_context, arrow_output);
+}
+
+// [[Rcpp::export]]
+SEXP line_arrow_caller(SEXP batch, int binary = 0, int dim = 100, int order = 2, int negative = 5, int samples = 1, float rho = 0.025, int threads = 1, double memory_budget = 0, bool context = false, double hub_vertices = 0, bool huge_pages = true, SEXP arrow_output = R_NilValue) {
+  if (hub_vertices < 0 || hub_vertices > INT_MAX / 2) Rcpp::stop("line: hub_vertices must be between 0 and %d", INT_MAX / 2);
+  ArrowEdges *edges = ArrowEdgesFromPointer("line", batch);
+  std::vector<std::string> output_vertices;
+  std::vector< std::vector<double> > output_features, output_context;
+
+  TrainLINEArrowMain(*edges, output_vertices, output_features, binary, dim, order, negative, samples, rho, threads, (long long) (memory_budget * 1048576),
+                     context ? &output_context : NULL, (long long) hub_vertices, huge_pages);
+  ArrowEdgesFree(edges);
+
+  TRACE_SCOPE("line_arrow_caller output conversion");
+  return LineOutput(output_vertices, output_features, output_context, arrow_output);
+}
+
+// [[Rcpp::export]]
+SEXP line_edges_caller(SEXP edges, int binary = 0, int dim = 100, int order = 2, int negative = 5, int samples = 1, float rho = 0.025, int threads = 1, double memory_budget = 0, bool context = false, double hub_vertices = 0, bool huge_pages = true, SEXP arrow_output = R_NilValue) {
+  if (hub_vertices < 0 || hub_vertices > INT_MAX / 2) Rcpp::stop("line: hub_vertices must be between 0 and %d", INT_MAX / 2);
+  const EdgeFile &input = *EdgeFileFromPointer(edges);
+  std::vector<std::string> output_vertices;
+  std::vector< std::vector<double> > output_features, output_context;
+
+  TrainLINEEdgeFileMain(input, output_vertices, output_features, binary, dim, order, negative, samples, rho, threads, (long long) (memory_budget * 1048576),
+                        context ? &output_context : NULL, (long long) hub_vertices, huge_pages);
+
+  TRACE_SCOPE("line_edges_caller output conversion");
+  return LineOutput(output_vertices, output_features, output_context, arrow_output);
+}
+
+// [[Rcpp::export]]
+SEXP line_graph_caller(Rcpp::IntegerVector p, Rcpp::IntegerVector i, Rcpp::NumericVector x, Rcpp::StringVector names, int binary = 0, int dim = 100, int order = 2, int negative = 5, int samples = 1, float rho = 0.025, int threads = 1, double memory_budget = 0, bool context = false, double hub_vertices = 0, bool huge_pages = true, SEXP arrow_output = R_NilValue) {
+  if (hub_vertices < 0 || hub_vertices > INT_MAX / 2) Rcpp::stop("line: hub_vertices must be between 0 and %d", INT_MAX / 2);
+  std::vector<long long> col_ptr;
+  std::vector<const char *> vertex_names;
+  CompressedGraph graph = SlotsGraph("line", p, i, x, names, col_ptr, vertex_names);
+  std::vector<std::string> output_vertices;
+  std::vector< std::vector<double> > output_features, output_context;
+
+  TrainLINEGraphMain(graph, output_vertices, output_features, binary, dim, order, negative, samples, rho, threads, (long long) (memory_budget * 1048576),
+                     context ? &output_context : NULL, (long long) hub_vertices, huge_pages);
+
+  TRACE_SCOPE("line_graph_caller output conversion");
+  return LineOutput(output_vertices, output_features, output_context, arrow_output);
+}
+
+// [[Rcpp::export]]
+Rcpp::NumericMatrix concatenate_caller(Rcpp::NumericMatrix input_one, Rcpp::NumericMatrix input_two, Rcpp::StringVector first_order_v, Rcpp::StringVector second_order_v, int binary = 0, int threads = 1, std::string join = "left", std::string fill = "nan") {
+  R_xlen_t first_order_rows = input_one.nrow(), second_order_rows = input_two.nrow();
+  if (first_order_v.size() != first_order_rows || second_order_v.size() != second_order_rows)
+    Rcpp::stop("concatenate: every row of input_one and input_two needs a row name");
+  int join_type = join == "inner" ? CONCATENATE_JOIN_INNER : join == "outer" ? CONCATENATE_JOIN_OUTER : CONCATENATE_JOIN_LEFT;
+  int fill_type = fill == "zero" ? CONCATENATE_FILL_ZERO : fill == "mean" ? CONCATENATE_FILL_MEAN : CONCATENATE_FILL_NAN;
+  std::vector<const char *> first_order_vertices(first_order_rows), second_order_vertices(second_order_rows);
+  std::vector<long long> output_first_rows, output_second_rows;
+  {
+    TRACE_SCOPE("concatenate_caller input conversion");
+    for (R_xlen_t i = 0; i < first_order_rows; i++) first_order_vertices[i] = CHAR(STRING_ELT(first_order_v, i));
+    for (R_xlen_t i = 0; i < second_order_rows; i++) second_order_vertices[i] = CHAR(STRING_ELT(second_order_v, i));
   }
-  
-  ConcatenateMain(first_order_vertices, second_order_vertices, output_vertices, first_order_features, second_order_features, output_features, binary);
 
-  long long row = (long long) output_features.size(), col = (long long) output_features[0].size();
-  Rcpp::NumericMatrix feature_matrix(row, col);
+  // The names point into R's string cache, so the names of two line results on the same graph are the same pointers
+  bool aligned = ConcatenateJoin(first_order_vertices.data(), first_order_rows, second_order_vertices.data(), second_order_rows,
+                                 join_type, output_first_rows, output_second_rows, threads) != 0;
+  R_xlen_t row = (R_xlen_t) output_first_rows.size();
+  Rcpp::NumericMatrix feature_matrix = Rcpp::no_init_matrix(row, input_one.ncol() + input_two.ncol());
+  ConcatenateMain(input_one.begin(), first_order_rows, input_one.ncol(), input_two.begin(), second_order_rows, input_two.ncol(),
+                  output_first_rows.data(), output_second_rows.data(), row, feature_matrix.begin(), fill_type, binary, threads);
+
+  TRACE_SCOPE("concatenate_caller output conversion");
+  if (aligned || join_type == CONCATENATE_JOIN_LEFT) {
+    Rcpp::rownames(feature_matrix) = first_order_v;
+    return feature_matrix;
+  }
   Rcpp::StringVector vertice_names(row);
-  vertice_names = output_vertices;
+  for (R_xlen_t r = 0; r < row; r++) {
+    if (output_first_rows[r] != -1) vertice_names[r] = first_order_v[output_first_rows[r]];
+    else vertice_names[r] = second_order_v[output_second_rows[r]];
+  }
   Rcpp::rownames(feature_matrix) = vertice_names;
+  return feature_matrix;
+}
+
+// [[Rcpp::export]]
+Rcpp::NumericMatrix concatenate_store_caller(SEXP graph, Rcpp::NumericMatrix input_one, Rcpp::NumericMatrix input_two, Rcpp::StringVector first_order_v, Rcpp::StringVector second_order_v, int binary = 0, int threads = 1, std::string fill = "nan") {
+  GraphStore *store = GraphFromPointer(graph);
+  R_xlen_t first_order_rows = input_one.nrow(), second_order_rows = input_two.nrow();
+  if (first_order_v.size() != first_order_rows || second_order_v.size() != second_order_rows)
+    Rcpp::stop("concatenate: every row of input_one and input_two needs a row name");
+  int fill_type = fill == "zero" ? CONCATENATE_FILL_ZERO : fill == "mean" ? CONCATENATE_FILL_MEAN : CONCATENATE_FILL_NAN;
+
+  // Every vertex of the graph gets an output row, joined to the rows of the matrices through the graph's own name
+  // table; like concatenate's joins, a vertex takes its first row in input_one and its last row in input_two
+  R_xlen_t row = (R_xlen_t) store->graph.num_vertices;
+  std::vector<long long> output_first_rows(row, -1), output_second_rows(row, -1);
+  {
+    TRACE_SCOPE("concatenate_store_caller join");
+    for (R_xlen_t i = 0; i < first_order_rows; i++) {
+      long long id = GraphFind(store, CHAR(STRING_ELT(first_order_v, i)));
+      if (id != -1 && output_first_rows[id] == -1) output_first_rows[id] = i;
+    }
+    for (R_xlen_t i = 0; i < second_order_rows; i++) {
+      long long id = GraphFind(store, CHAR(STRING_ELT(second_order_v, i)));
+      if (id != -1) output_second_rows[id] = i;
+    }
+  }
+  Rcpp::NumericMatrix feature_matrix = Rcpp::no_init_matrix(row, input_one.ncol() + input_two.ncol());
+  ConcatenateMain(input_one.begin(), first_order_rows, input_one.ncol(), input_two.begin(), second_order_rows, input_two.ncol(),
+                  output_first_rows.data(), output_second_rows.data(), row, feature_matrix.begin(), fill_type, binary, threads);
+
+  TRACE_SCOPE("concatenate_store_caller output conversion");
+  Rcpp::rownames(feature_matrix) = graph_vertices_caller(graph);
+  return feature_matrix;
+}
+
+// [[Rcpp::export]]
+Rcpp::NumericMatrix normalize_caller(Rcpp::NumericMatrix input_matrix, bool in_place = false, bool line_precision = false, int threads = 1) {
+  Rcpp::NumericMatrix output_matrix = input_matrix;
+  if (!in_place) output_matrix = Rcpp::no_init_matrix(input_matrix.nrow(), input_matrix.ncol());
+  NormalizeMain(input_matrix.begin(), input_matrix.nrow(), input_matrix.ncol(), output_matrix.begin(), line_precision ? 1 : 0, threads);
+  if (!in_place) output_matrix.attr("dimnames") = input_matrix.attr("dimnames");
+  return output_matrix;
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame benchmark_update_caller(Rcpp::IntegerVector dims, Rcpp::NumericVector working_set_mb, Rcpp::LogicalVector huge_pages,
+                                        double samples = 1, int negative = 5, int threads = 1) {
+  std::vector<int> id(dims.begin(), dims.end());
+  std::vector<double> iws(working_set_mb.begin(), working_set_mb.end());
+  std::vector<int> ihp(huge_pages.begin(), huge_pages.end());
+  std::vector<UpdateBenchmarkResult> results;
+
+  BenchmarkUpdateMain(id, iws, ihp, samples, negative, threads, results);
+
+  long long row = (long long) results.size();
+  Rcpp::IntegerVector out_dim(row), out_simd_floats(row);
+  Rcpp::NumericVector out_rows(row), out_ws(row), out_seconds(row), out_gflops(row), out_gbs(row), out_intensity(row),
+                      out_peak_gflops(row), out_peak_gbs(row), out_roof(row), out_efficiency(row), out_dtlb(row);
+  Rcpp::StringVector out_bound(row), out_pages(row), out_simd(row);
   for (long long r = 0; r < row; r++) {
-      for (long long c = 0; c < col; c++) {
-        feature_matrix(r, c) = output_features[r][c];
-      }
+    out_dim[r] = results[r].dim;
+    out_rows[r] = (double) results[r].rows;
+    out_ws[r] = results[r].working_set_mb;
+    out_seconds[r] = results[r].seconds;
+    out_gflops[r] = results[r].gflops;
+    out_gbs[r] = results[r].gbs;
+    out_intensity[r] = results[r].intensity;
+    out_peak_gflops[r] = results[r].peak_gflops;
+    out_peak_gbs[r] = results[r].peak_gbs;
+    out_roof[r] = results[r].roof_gflops;
+    out_efficiency[r] = results[r].gflops / results[r].roof_gflops;
+    out_bound[r] = results[r].bound;
+    out_pages[r] = results[r].pages;
+    out_dtlb[r] = results[r].dtlb_misses;
+    out_simd[r] = results[r].simd;
+    out_simd_floats[r] = results[r].simd_floats;
+  }
+  return Rcpp::DataFrame::create(Rcpp::Named("dim") = out_dim, Rcpp::Named("rows") = out_rows, Rcpp::Named("working_set_mb") = out_ws,
+                                 Rcpp::Named("seconds") = out_seconds, Rcpp::Named("gflops") = out_gflops, Rcpp::Named("gbs") = out_gbs,
+                                 Rcpp::Named("intensity") = out_intensity, Rcpp::Named("peak_gflops") = out_peak_gflops,
+                                 Rcpp::Named("peak_gbs") = out_peak_gbs, Rcpp::Named("roof_gflops") = out_roof,
+                                 Rcpp::Named("efficiency") = out_efficiency, Rcpp::Named("bound") = out_bound,
+                                 Rcpp::Named("pages") = out_pages, Rcpp::Named("dtlb_misses") = out_dtlb,
+                                 Rcpp::Named("simd") = out_simd, Rcpp::Named("simd_floats") = out_simd_floats,
+                                 Rcpp::Named("stringsAsFactors") = false);
+}
+
+// [[Rcpp::export]]
+bool perf_counters_caller(bool enable = true) {
+  bool previous = PerfEnabled() != 0;
+  PerfEnable(enable ? 1 : 0);
+  return previous;
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame perf_report_caller() {
+  const std::vector<PerfRecord> &records = PerfReport();
+  long long row = (long long) records.size();
+  Rcpp::StringVector out_phase(row);
+  Rcpp::IntegerVector out_thread(row);
+  Rcpp::NumericVector out_seconds(row), out_rss(row), out_cycles(row), out_instructions(row), out_ipc(row), out_cache(row), out_dtlb(row), out_branch(row);
+  for (long long r = 0; r < row; r++) {
+    const PerfRecord &record = records[r];
+    out_phase[r] = record.phase;
+    out_thread[r] = record.thread < 0 ? NA_INTEGER : record.thread;
+    out_seconds[r] = record.seconds;
+    out_rss[r] = record.peak_rss < 0 ? NA_REAL : record.peak_rss / 1048576.0;
+    out_cycles[r] = record.values[PERF_CYCLES] < 0 ? NA_REAL : (double) record.values[PERF_CYCLES];
+    out_instructions[r] = record.values[PERF_INSTRUCTIONS] < 0 ? NA_REAL : (double) record.values[PERF_INSTRUCTIONS];
+    out_ipc[r] = record.values[PERF_CYCLES] <= 0 || record.values[PERF_INSTRUCTIONS] < 0 ? NA_REAL : (double) record.values[PERF_INSTRUCTIONS] / record.values[PERF_CYCLES];
+    out_cache[r] = record.values[PERF_CACHE_MISSES] < 0 ? NA_REAL : (double) record.values[PERF_CACHE_MISSES];
+    out_dtlb[r] = record.values[PERF_DTLB_MISSES] < 0 ? NA_REAL : (double) record.values[PERF_DTLB_MISSES];
+    out_branch[r] = record.values[PERF_BRANCH_MISSES] < 0 ? NA_REAL : (double) record.values[PERF_BRANCH_MISSES];
+  }
+  return Rcpp::DataFrame::create(Rcpp::Named("phase") = out_phase, Rcpp::Named("thread") = out_thread, Rcpp::Named("seconds") = out_seconds,
+                                 Rcpp::Named("peak_rss_mb") = out_rss, Rcpp::Named("cycles") = out_cycles, Rcpp::Named("instructions") = out_instructions, Rcpp::Named("ipc") = out_ipc,
+                                 Rcpp::Named("cache_misses") = out_cache, Rcpp::Named("dtlb_misses") = out_dtlb,
+                                 Rcpp::Named("branch_misses") = out_branch, Rcpp::Named("stringsAsFactors") = false);
+}
+
+// [[Rcpp::export]]
+bool trace_start_caller(std::string file) {
+  return TraceStart(file.c_str()) != 0;
+}
+
+// [[Rcpp::export]]
+int trace_stop_caller() {
+  return TraceStop();
+}
+
+// For tests: the number of vertices above which line takes 64-bit vertex ids, 0 for the default of 2^31 - 1
+// [[Rcpp::export]]
+double line_vertex_id_limit_caller(double limit = 0) {
+  return (double) LINEVertexIdLimit((long long) limit);
+}
+
+// For tests: the number of threads line reads a data frame on, 0 for the number of training threads
+// [[Rcpp::export]]
+int line_read_threads_caller(int threads = 0) {
+  return LINEReadThreads(threads);
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame memory_report_caller() {
+  const LineMemoryPlan &plan = LastLINEMemoryPlan();
+  Rcpp::StringVector out_phase(LINE_NUM_PHASES);
+  Rcpp::NumericVector out_allocated(LINE_NUM_PHASES), out_live(LINE_NUM_PHASES), out_rss(LINE_NUM_PHASES);
+  for (int p = 0; p < LINE_NUM_PHASES; p++) {
+    long long peak_rss = PerfPeakRSS(line_memory_phase_names[p]);
+    out_phase[p] = line_memory_phase_names[p];
+    out_allocated[p] = plan.allocated[p] / 1048576.0;
+    out_live[p] = plan.live[p] / 1048576.0;
+    out_rss[p] = peak_rss < 0 ? NA_REAL : peak_rss / 1048576.0;
+  }
+  Rcpp::DataFrame report = Rcpp::DataFrame::create(Rcpp::Named("phase") = out_phase, Rcpp::Named("allocated_mb") = out_allocated,
+                                                   Rcpp::Named("planned_mb") = out_live, Rcpp::Named("peak_rss_mb") = out_rss,
+                                                   Rcpp::Named("stringsAsFactors") = false);
+  report.attr("num_edges") = (double) plan.num_edges;
+  report.attr("num_vertices") = (double) plan.num_vertices;
+  report.attr("hash_table_size") = (double) plan.hash_table_size;
+  report.attr("neg_table_size") = (double) plan.neg_table_size;
+  report.attr("budget_mb") = plan.budget / 1048576.0;
+  return report;
+}
+
+typedef Rcpp::XPtr<HnswIndex, Rcpp::PreserveStorage, HnswFree> HnswPointer;
+
+static HnswIndex *HnswFromPointer(SEXP index) {
+  HnswPointer pointer(index);
+  if (pointer.get() == NULL) Rcpp::stop("the hnsw index is no longer valid, build it again or load it with hnsw_load");
+  return pointer.get();
+}
+
+// [[Rcpp::export]]
+SEXP hnsw_build_caller(Rcpp::NumericMatrix embedding, Rcpp::StringVector names, std::string metric = "cosine", int M = 16, int ef_construction = 200, int threads = 1) {
+  if (embedding.nrow() > INT_MAX) Rcpp::stop("hnsw_build: the embedding has more than INT_MAX rows");
+  std::vector<const char *> in(names.size());
+  for (R_xlen_t i = 0; i < names.size(); i++) in[i] = CHAR(STRING_ELT(names, i));
+
+  HnswIndex *index = HnswBuild(embedding.begin(), embedding.nrow(), embedding.ncol(), in.empty() ? NULL : &in[0],
+                               metric == "ip" ? HNSW_INNER_PRODUCT : HNSW_COSINE, M, ef_construction, threads);
+  if (index == NULL) Rcpp::stop("hnsw_build: memory allocation failed");
+  return HnswPointer(index, true);
+}
+
+// [[Rcpp::export]]
+Rcpp::List hnsw_search_caller(SEXP index, Rcpp::NumericMatrix query, int k = 10, int ef = 50, int threads = 1) {
+  HnswIndex *hnsw = HnswFromPointer(index);
+  if (query.ncol() != hnsw->dim) Rcpp::stop("hnsw_search: query has %d columns but the index has %d", query.ncol(), hnsw->dim);
+  if (k < 1) Rcpp::stop("hnsw_search: k must be at least 1");
+  if (ef < k) ef = k;
+
+  int rows = query.nrow();
+  Rcpp::IntegerMatrix out_index(rows, k);
+  Rcpp::NumericMatrix out_similarity(rows, k);
+  Rcpp::StringMatrix out_neighbor(rows, k);
+  HnswSearch(hnsw, query.begin(), rows, k, ef, threads, out_index.begin(), out_similarity.begin());
+  for (R_xlen_t i = 0; i < out_index.size(); i++) {
+    if (out_index[i] < 0) {
+      out_index[i] = NA_INTEGER;
+      out_neighbor[i] = NA_STRING;
+    }
+    else {
+      out_neighbor[i] = hnsw->names[out_index[i]];
+      out_index[i]++;
+    }
+  }
+  return Rcpp::List::create(Rcpp::Named("index") = out_index, Rcpp::Named("neighbor") = out_neighbor,
+                            Rcpp::Named("similarity") = out_similarity);
+}
+
+// [[Rcpp::export]]
+Rcpp::List hnsw_info_caller(SEXP index) {
+  HnswIndex *hnsw = HnswFromPointer(index);
+  return Rcpp::List::create(Rcpp::Named("size") = (double) hnsw->num_vectors, Rcpp::Named("dim") = hnsw->dim,
+                            Rcpp::Named("metric") = hnsw->metric == HNSW_INNER_PRODUCT ? "ip" : "cosine",
+                            Rcpp::Named("M") = hnsw->M, Rcpp::Named("ef_construction") = hnsw->ef_construction,
+                            Rcpp::Named("levels") = hnsw->max_level + 1);
+}
+
+// [[Rcpp::export]]
+bool hnsw_save_caller(SEXP index, std::string file) {
+  if (!HnswSave(HnswFromPointer(index), file.c_str())) Rcpp::stop("hnsw_save: cannot write %s", file);
+  return true;
+}
+
+// [[Rcpp::export]]
+SEXP hnsw_load_caller(std::string file) {
+  HnswIndex *index = HnswLoad(file.c_str());
+  if (index == NULL) Rcpp::stop("hnsw_load: %s is missing, truncated, corrupt or not an hnsw index", file);
+  return HnswPointer(index, true);
+}
+
+// [[Rcpp::export]]
+Rcpp::List top_k_caller(Rcpp::NumericMatrix embedding, int k = 10, std::string metric = "cosine", bool exclude_self = true, int threads = 1) {
+  if (embedding.nrow() > INT_MAX) Rcpp::stop("top_k_neighbors: the embedding has more than INT_MAX rows");
+  if (k < 1) Rcpp::stop("top_k_neighbors: k must be at least 1");
+  int rows = embedding.nrow();
+  Rcpp::IntegerMatrix out_index(rows, k);
+  Rcpp::NumericMatrix out_similarity(rows, k);
+  TopKSimilarityMain(embedding.begin(), rows, embedding.ncol(), k, out_index.begin(), out_similarity.begin(),
+                     metric == "ip" ? 0 : 1, exclude_self ? 1 : 0, threads);
+  for (R_xlen_t i = 0; i < out_index.size(); i++) {
+    if (out_index[i] < 0) out_index[i] = NA_INTEGER;
+    else out_index[i]++;
+  }
+  return Rcpp::List::create(Rcpp::Named("index") = out_index, Rcpp::Named("similarity") = out_similarity);
+}
+
+// [[Rcpp::export]]
+Rcpp::List link_prediction_caller(Rcpp::NumericMatrix embedding, Rcpp::IntegerVector source, Rcpp::IntegerVector target,
+                                  Rcpp::IntegerVector graph_u, Rcpp::IntegerVector graph_v, Rcpp::NumericVector graph_w,
+                                  int negative = 1, std::string metric = "ip", double seed = 1, Rcpp::NumericVector k = 10, int threads = 1) {
+  if (embedding.nrow() > INT_MAX) Rcpp::stop("link_prediction: the embedding has more than INT_MAX rows");
+  std::vector<int> is(source.size()), it(target.size());
+  for (R_xlen_t i = 0; i < source.size(); i++) {
+    is[i] = source[i] - 1;
+    it[i] = target[i] - 1;
+  }
+  std::vector<double> degree(embedding.nrow(), 0.0);
+  for (R_xlen_t i = 0; i < graph_u.size(); i++) {
+    if (graph_u[i] != NA_INTEGER) degree[graph_u[i] - 1] += graph_w[i];
+    if (graph_v[i] != NA_INTEGER) degree[graph_v[i] - 1] += graph_w[i];
+  }
+  std::vector<long long> ik(k.size());
+  for (R_xlen_t i = 0; i < k.size(); i++) ik[i] = (long long) k[i];
+
+  LinkPredictionResult result;
+  LinkPredictionMain(embedding.begin(), embedding.nrow(), embedding.ncol(), is.empty() ? NULL : &is[0], it.empty() ? NULL : &it[0],
+                     (long long) is.size(), embedding.nrow() == 0 ? NULL : &degree[0], negative, metric == "cosine" ? 1 : 0,
+                     (unsigned long long) seed, ik, threads, result);
+  return Rcpp::List::create(Rcpp::Named("auc") = result.auc, Rcpp::Named("precision") = Rcpp::wrap(result.precision),
+                            Rcpp::Named("positives") = (double) result.num_positive, Rcpp::Named("negatives") = (double) result.num_negative);
+}
+
+// [[Rcpp::export]]
+Rcpp::NumericMatrix fold_in_caller(Rcpp::NumericMatrix embedding, Rcpp::NumericMatrix context, Rcpp::IntegerVector source, Rcpp::IntegerVector target,
+                                   Rcpp::NumericVector weight, Rcpp::StringVector new_vertices, Rcpp::IntegerVector graph_u, Rcpp::IntegerVector graph_v,
+                                   Rcpp::NumericVector graph_w, int order = 2, int negative = 5, double samples = 0.1, float rho = 0.025, int threads = 1) {
+  R_xlen_t num_new = new_vertices.size();
+  if (embedding.nrow() + num_new > INT_MAX) Rcpp::stop("fold_in: more than INT_MAX vertices");
+  std::vector<int> is(source.size()), it(target.size());
+  for (R_xlen_t i = 0; i < source.size(); i++) {
+    is[i] = source[i] - 1;
+    it[i] = target[i] - 1;
+  }
+  // Without the training graph the negatives are uniform over the vertices
+  std::vector<double> degree(graph_u.size() == 0 ? 0 : embedding.nrow() + num_new, 0.0);
+  for (R_xlen_t i = 0; i < graph_u.size(); i++) {
+    if (graph_u[i] != NA_INTEGER) degree[graph_u[i] - 1] += graph_w[i];
+    if (graph_v[i] != NA_INTEGER) degree[graph_v[i] - 1] += graph_w[i];
+  }
+  for (R_xlen_t i = 0; !degree.empty() && i < source.size(); i++) {
+    degree[is[i]] += weight[i];
+    degree[it[i]] += weight[i];
   }
+
+  Rcpp::NumericMatrix output_vertex(num_new, embedding.ncol()), output_context(order == 2 ? num_new : 0, embedding.ncol());
+  int done = FoldInMain(embedding.begin(), order == 2 ? context.begin() : NULL, embedding.nrow(), num_new, embedding.ncol(),
+                        is.empty() ? NULL : &is[0], it.empty() ? NULL : &it[0], weight.begin(), (long long) is.size(),
+                        degree.empty() ? NULL : &degree[0], order, negative, samples, rho, threads, output_vertex.begin(),
+                        order == 2 ? output_context.begin() : NULL);
+  if (!done) Rcpp::stop("fold_in: memory allocation failed");
+  Rcpp::rownames(output_vertex) = new_vertices;
+  if (order == 2) {
+    Rcpp::rownames(output_context) = new_vertices;
+    output_vertex.attr("context") = output_context;
+  }
+  return output_vertex;
+}
+
+// [[Rcpp::export]]
+Rcpp::NumericMatrix walk_caller(Rcpp::IntegerVector source, Rcpp::IntegerVector target, Rcpp::NumericVector weight, Rcpp::StringVector vertices,
+                                int dim = 100, int walk_length = 80, int num_walks = 10, int window = 10, double p = 1, double q = 1,
+                                int negative = 5, float rho = 0.025, int threads = 1) {
+  if (vertices.size() > INT_MAX) Rcpp::stop("node2vec: more than INT_MAX vertices");
+  if (p <= 0 || q <= 0) Rcpp::stop("node2vec: p and q must be positive");
+  std::vector<int> is(source.size()), it(target.size());
+  for (R_xlen_t i = 0; i < source.size(); i++) {
+    is[i] = source[i] - 1;
+    it[i] = target[i] - 1;
+  }
+
+  Rcpp::NumericMatrix feature_matrix(vertices.size(), dim);
+  int done = TrainWalkMain(is.empty() ? NULL : &is[0], it.empty() ? NULL : &it[0], weight.begin(), (long long) is.size(), vertices.size(),
+                           dim, walk_length, num_walks, window, p, q, negative, rho, threads, feature_matrix.begin());
+  if (!done) Rcpp::stop("node2vec: memory allocation failed");
+  Rcpp::rownames(feature_matrix) = vertices;
   return feature_matrix;
 }
 
+// [[Rcpp::export]]
+Rcpp::NumericMatrix pte_caller(Rcpp::IntegerVector source, Rcpp::IntegerVector target, Rcpp::NumericVector weight, Rcpp::IntegerVector relation,
+                               Rcpp::StringVector vertices, Rcpp::NumericVector relation_weight, int dim = 100, int order = 2, int negative = 5,
+                               double samples = 1, float rho = 0.025, int threads = 1) {
+  if (vertices.size() > INT_MAX) Rcpp::stop("pte: more than INT_MAX vertices");
+  if (order != 1 && order != 2) Rcpp::stop("pte: order should be either 1 or 2");
+  std::vector<int> is(source.size()), it(target.size()), ir(relation.size());
+  for (R_xlen_t i = 0; i < source.size(); i++) {
+    is[i] = source[i] - 1;
+    it[i] = target[i] - 1;
+    ir[i] = relation[i] - 1;
+  }
+
+  Rcpp::NumericMatrix feature_matrix(vertices.size(), dim);
+  int done = TrainPTEMain(is.empty() ? NULL : &is[0], it.empty() ? NULL : &it[0], weight.begin(), ir.empty() ? NULL : &ir[0], (long long) is.size(),
+                          vertices.size(), relation_weight.size(), relation_weight.begin(), dim, order, negative, samples, rho, threads,
+                          feature_matrix.begin());
+  if (!done) Rcpp::stop("pte: memory allocation failed");
+  Rcpp::rownames(feature_matrix) = vertices;
+  return feature_matrix;
+}
@@ -0,0 +1,33 @@
+/*
+Helpers for graphs read straight from the buffers of a sparse adjacency matrix.
+
+The vertex table of such a graph is given by the rows of the matrix, and includes vertices
+without edges, which a data frame of edges never contains. They are dropped by renumbering the
+remaining vertices in the order of the matrix.
+*/
+
+#include <string.h>
+#include "compressed_graph.h"
+
+/* Number the vertices that have at least one edge 0, 1, ... in matrix order into id, and the
+   others -1; returns the number of vertices with edges */
+long long CompactGraphVertices(const CompressedGraph &graph, long long *id)
+{
+	for (long long k = 0; k != graph.num_vertices; k++) id[k] = -1;
+	for (long long j = 0; j != graph.num_vertices; j++)
+	{
+		if (graph.col_ptr[j + 1] > graph.col_ptr[j]) id[j] = 0;
+		for (long long e = graph.col_ptr[j]; e != graph.col_ptr[j + 1]; e++) id[graph.row[e]] = 0;
+	}
+	long long count = 0;
+	for (long long k = 0; k != graph.num_vertices; k++) if (id[k] == 0) id[k] = count++;
+	return count;
+}
+
+/* Average vertex name length, estimated from the first vertices */
+double GraphNameLength(const CompressedGraph &graph)
+{
+	long long n = graph.num_vertices < 10000 ? graph.num_vertices : 10000, length = 0;
+	for (long long k = 0; k != n; k++) length += strlen(graph.names[k]);
+	return n == 0 ? 0 : (double)length / n;
+}
@@ -0,0 +1,29 @@
+#include <climits>
+
+#ifndef COMPRESSED_GRAPH_H
+#define COMPRESSED_GRAPH_H
+
+// A weighted directed graph in compressed sparse column form, laid out as the slots of a dgCMatrix
+// adjacency matrix but with 64-bit column pointers, so that it can hold more than 2^31 - 1 edges:
+// the edges into vertex j come from row[e] with weight[e] for e in [col_ptr[j], col_ptr[j + 1]).
+// Vertex k is named names[k]. All arrays are borrowed, and an alias table saved with the graph
+// spares line building its own.
+struct CompressedGraph {
+	long long num_vertices, num_edges;
+	const long long *col_ptr;
+	const int *row;
+	const double *weight;
+	const char **names;
+	const void *alias;                     // alias table of the edge weights in edge order, or NULL
+	const double *prob;
+};
+
+// The alias table of a graph holds int edge ids below 2^31 - 1 edges, as line's do, and long long ones from there on
+inline int GraphAliasIsInt(long long num_edges)
+{
+	return num_edges < INT_MAX;
+}
+
+long long CompactGraphVertices(const CompressedGraph &graph, long long *id);
+double GraphNameLength(const CompressedGraph &graph);
+#endif
@@ -1,76 +1,146 @@
+/*
+Concatenation of a first order and a second order embedding.
+
+The rows of the two matrices are joined on the vertex names with an open addressing hash table
+sized for the matrix it indexes, which all threads fill at once with compare and swap. Every
+output row is then normalized per half and written straight into the column-major output.
+*/
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <atomic>
+#include <new>
 #include <vector>
 #include <string> 
+#include "perf_counters.h"
+#include "trace.h"
+#include "simd.h"
+#include "parallel.h"
+#include "arena.h"
+#include "concatenate_vector.h"
 
 #define MAX_STRING 100
+// Rows normalized together; the block of every column is still in cache when it is divided
+#define ROW_BLOCK 512
+// Names hashed or looked up per task
+#define NAME_BLOCK 4096
 
-static const int hash_table_size = 30000000;
-
-typedef float real;                    // Precision of float numbers
-
-struct ClassVertex {
-	double degree;
-	char *name;
+// Hash table from vertex names to the rows of one matrix. A name that occurs in several rows
+// maps to its first or its last row.
+struct NameIndex {
+	const char **names;
+	std::atomic<long long> *table;
+	unsigned long long mask;
+	int keep_last;
 };
 
 static char vector_file1[MAX_STRING], vector_file2[MAX_STRING], output_file[MAX_STRING];
-static struct ClassVertex *vertex;
-static int binary = 0;
-static int *vertex_hash_table;
-static long long num_vertices = 0;
+static int binary = 0, fill = CONCATENATE_FILL_NAN;
+static long long num_rows1 = 0, num_rows2 = 0, num_output_rows = 0;
 static long long vector_dim1, vector_dim2;
-static real *vec1, *vec2;
+static const double *vec1, *vec2;
+static double *output, *len1, *len2, *fill1, *fill2;
+static const long long *output_rows1, *output_rows2;
+static NameIndex index1, index2;
+static const char **names1;
+static long long *rows2;
+static char *second_only;
+static Arena scratch = ARENA_INIT;    // name indexes and per-row scratch of a call, released at its end
 
-/* Build a hash table, mapping each vertex name to a unique vertex id */
-static unsigned int Hash(char *key)
+/* FNV-1a hash of a vertex name */
+static unsigned long long Hash(const char *key)
 {
-	unsigned int seed = 131;
-	unsigned int hash = 0;
+	unsigned long long hash = 14695981039346656037ULL;
 	while (*key)
 	{
-		hash = hash * seed + (*key++);
+		hash ^= (unsigned char)(*key++);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/* Scratch memory that lives until the end of the call; throws std::bad_alloc like new if out of memory */
+static void *ScratchAlloc(size_t bytes)
+{
+	void *p = ArenaAlloc(&scratch, bytes);
+	if (p == NULL)
+	{
+		ArenaRelease(&scratch);
+		throw std::bad_alloc();
 	}
-	return hash % hash_table_size;
+	return p;
 }
 
-static void InitHashTable()
+static void InitNameIndex(NameIndex *index, const char **names, long long num_names, int keep_last)
 {
-	vertex_hash_table = (int *)malloc(hash_table_size * sizeof(int));
-	for (int k = 0; k != hash_table_size; k++) vertex_hash_table[k] = -1;
+	unsigned long long size = 1024;
+	while (size < 2 * (unsigned long long)num_names) size *= 2;
+	index->names = names;
+	index->table = (std::atomic<long long> *)ScratchAlloc(size * sizeof(std::atomic<long long>));
+	index->mask = size - 1;
+	index->keep_last = keep_last;
+	for (unsigned long long k = 0; k != size; k++) new (&index->table[k]) std::atomic<long long>(-1);
 }
 
-static void InsertHashTable(char *key, int value)
+static void InsertNameIndex(NameIndex *index, long long row)
 {
-	int addr = Hash(key);
-	while (vertex_hash_table[addr] != -1) addr = (addr + 1) % hash_table_size;
-	vertex_hash_table[addr] = value;
+	const char *name = index->names[row];
+	unsigned long long addr = Hash(name) & index->mask;
+	while (1)
+	{
+		long long cur = index->table[addr].load();
+		if (cur == -1)
+		{
+			if (index->table[addr].compare_exchange_weak(cur, row)) return;
+			continue;
+		}
+		if (!strcmp(name, index->names[cur]))
+		{
+			// Another thread got here first with the same name, keep the row that wins
+			if (index->keep_last ? row <= cur : row >= cur) return;
+			if (index->table[addr].compare_exchange_weak(cur, row)) return;
+			continue;
+		}
+		addr = (addr + 1) & index->mask;
+	}
 }
 
-static int SearchHashTable(char *key)
+static long long SearchNameIndex(const NameIndex *index, const char *name)
 {
-	int addr = Hash(key);
+	unsigned long long addr = Hash(name) & index->mask;
 	while (1)
 	{
-		if (vertex_hash_table[addr] == -1) return -1;
-		if (!strcmp(key, vertex[vertex_hash_table[addr]].name)) return vertex_hash_table[addr];
-		addr = (addr + 1) % hash_table_size;
+		long long cur = index->table[addr].load(std::memory_order_relaxed);
+		if (cur == -1) return -1;
+		if (!strcmp(name, index->names[cur])) return cur;
+		addr = (addr + 1) & index->mask;
 	}
 	return -1;
 }
 
-/* Add a vertex to the vertex set */
-static int AddVertex(char *name, int vid)
+static void BuildIndex1Task(long long begin, long long end, void *arg)
 {
-	int length = strlen(name) + 1;
-	if (length > MAX_STRING) length = MAX_STRING;
-	vertex[vid].name = (char *)calloc(length, sizeof(char));
-	strcpy(vertex[vid].name, name);
-	vertex[vid].degree = 0;
-	InsertHashTable(name, vid);
-	return vid;
+	for (long long k = begin; k != end; k++) InsertNameIndex(&index1, k);
+}
+
+static void BuildIndex2Task(long long begin, long long end, void *arg)
+{
+	for (long long k = begin; k != end; k++) InsertNameIndex(&index2, k);
+}
+
+/* The second order row of every first order row */
+static void MatchFirstOrderTask(long long begin, long long end, void *arg)
+{
+	for (long long k = begin; k != end; k++) rows2[k] = SearchNameIndex(&index2, names1[k]);
+}
+
+/* Second order rows whose vertex has no first order row, counting each name once */
+static void MatchSecondOrderTask(long long begin, long long end, void *arg)
+{
+	for (long long k = begin; k != end; k++)
+		second_only[k] = SearchNameIndex(&index2, index2.names[k]) == k && SearchNameIndex(&index1, index2.names[k]) == -1;
 }
 
 static void ReadVectors(std::vector<std::string> &first_order_vertices, std::vector<std::string> &second_order_vertices, 
@@ -121,80 +191,180 @@ static void ReadVectors(std::vector<std::string> &first_order_vertices, std::vec
 }
 
 
-static void InitVectors(const std::vector<std::string> &first_order_vertices, const std::vector<std::string> &second_order_vertices, 
-				const std::vector< std::vector<double> > &first_order_features, const std::vector< std::vector<double> > &second_order_features) {
-	char name[MAX_STRING];
-	real f_num;
-	long long l;
-
-	num_vertices = (long long) first_order_features.size();
-	vector_dim1 = (long long) first_order_features[0].size();
-	vertex = (struct ClassVertex *)calloc(num_vertices, sizeof(struct ClassVertex));
-	vec1 = (real *)calloc(num_vertices * vector_dim1, sizeof(real));
-	for (long long k = 0; k != num_vertices; k++)
+/* Whether the two name lists are the same strings, not just equal ones, in the same order. R keeps one copy
+   of every string, so this holds for the row names of two line results on the same graph. */
+static int SameVertexOrder(const char **first_order_vertices, long long first_order_rows, const char **second_order_vertices, long long second_order_rows)
+{
+	if (first_order_rows != second_order_rows) return 0;
+	for (long long k = 0; k != first_order_rows; k++) if (first_order_vertices[k] != second_order_vertices[k]) return 0;
+	return 1;
+}
+
+/* Join the vertices of the two matrices. Every output row gets the row of the first and of the second order
+   matrix it comes from, -1 where a matrix has no row for its vertex. Left joins keep the rows of the first
+   matrix, inner joins the ones that are also in the second, and outer joins add the vertices that are only in
+   the second. A second order name that occurs in several rows joins its last row. Matrices whose rows are the
+   same names in the same order are joined row by row without hashing any name; returns 1 if they were. The
+   join only shows on the trace timeline, the performance records of a call start with ConcatenateMain. */
+int ConcatenateJoin(const char **first_order_vertices, long long first_order_rows, const char **second_order_vertices, long long second_order_rows,
+					int join, std::vector<long long> &output_first_rows, std::vector<long long> &output_second_rows, int num_threads) {
+	TRACE_SCOPE("ConcatenateJoin");
+	names1 = first_order_vertices;
+	num_rows1 = first_order_rows;
+	num_rows2 = second_order_rows;
+
+	if (SameVertexOrder(first_order_vertices, first_order_rows, second_order_vertices, second_order_rows))
+	{
+		output_first_rows.resize(num_rows1);
+		output_second_rows.resize(num_rows1);
+		for (long long k = 0; k != num_rows1; k++) output_first_rows[k] = output_second_rows[k] = k;
+		return 1;
+	}
+
+	rows2 = (long long *)ScratchAlloc((num_rows1 + 1) * sizeof(long long));
+	InitNameIndex(&index2, second_order_vertices, num_rows2, 1);
+	ParallelFor(num_rows2, NAME_BLOCK, num_threads, BuildIndex2Task, NULL);
+	ParallelFor(num_rows1, NAME_BLOCK, num_threads, MatchFirstOrderTask, NULL);
+
+	output_first_rows.clear();
+	output_second_rows.clear();
+	for (long long k = 0; k != num_rows1; k++)
+	{
+		if (join == CONCATENATE_JOIN_INNER && rows2[k] == -1) continue;
+		output_first_rows.push_back(k);
+		output_second_rows.push_back(rows2[k]);
+	}
+	if (join == CONCATENATE_JOIN_OUTER)
 	{
-		strcpy(name, first_order_vertices[k].c_str());
-		AddVertex(name, k);
-		l = k * vector_dim1;
-		for (int c = 0; c != vector_dim1; c++)
+		second_only = (char *)ScratchAlloc(num_rows2 + 1);
+		InitNameIndex(&index1, first_order_vertices, num_rows1, 0);
+		ParallelFor(num_rows1, NAME_BLOCK, num_threads, BuildIndex1Task, NULL);
+		ParallelFor(num_rows2, NAME_BLOCK, num_threads, MatchSecondOrderTask, NULL);
+		for (long long k = 0; k != num_rows2; k++) if (second_only[k])
 		{
-			f_num = (real) first_order_features[k][c];
-			vec1[c + l] = (real)f_num;
+			output_first_rows.push_back(-1);
+			output_second_rows.push_back(k);
 		}
 	}
-	
-	l = (long long) second_order_features.size();
-	vector_dim2 = (long long) second_order_features[0].size();
-	vec2 = (real *)calloc((num_vertices + 1) * vector_dim2, sizeof(real));
-	for (long long k = 0; k != num_vertices; k++)
+	ArenaRelease(&scratch);
+	index1.table = index2.table = NULL;
+	rows2 = NULL;
+	second_only = NULL;
+	return 0;
+}
+
+static void FirstOrderNormsTask(long long begin, long long end, void *arg)
+{
+	for (long long b = begin; b < end; b += ROW_BLOCK)
+		RowNorms(vec1, num_rows1, vector_dim1, b, b + ROW_BLOCK < end ? b + ROW_BLOCK : end, len1);
+}
+
+static void SecondOrderNormsTask(long long begin, long long end, void *arg)
+{
+	for (long long b = begin; b < end; b += ROW_BLOCK)
+		RowNorms(vec2, num_rows2, vector_dim2, b, b + ROW_BLOCK < end ? b + ROW_BLOCK : end, len2);
+}
+
+/* Mean of the normalized rows of a matrix for columns [begin, end), skipping rows of length zero */
+static void ColumnMeans(const double *vec, long long rows, const double *len, long long begin, long long end, double *mean)
+{
+	for (long long c = begin; c != end; c++)
 	{
-		strcpy(name, second_order_vertices[k].c_str());
-		int i = SearchHashTable(name);
-		if (i == -1) l = num_vertices * vector_dim2;
-		else l = i * vector_dim2;
-		for (int c = 0; c != vector_dim2; c++)
+		double sum = 0;
+		long long count = 0;
+		for (long long r = 0; r != rows; r++) if (len[r] > 0)
 		{
-			f_num = (real) second_order_features[k][c];
-			vec2[c + l] = (real) f_num;
-
+			sum += vec[c * rows + r] / len[r];
+			count++;
 		}
+		mean[c] = count == 0 ? 0 : sum / count;
 	}
+}
+
+static void FirstOrderMeansTask(long long begin, long long end, void *arg)
+{
+	ColumnMeans(vec1, num_rows1, len1, begin, end, fill1);
+}
+
+static void SecondOrderMeansTask(long long begin, long long end, void *arg)
+{
+	ColumnMeans(vec2, num_rows2, len2, begin, end, fill2);
+}
 
-	//printf("Vocab size: %lld\n", num_vertices);
-	//printf("Vector size 1: %lld\n", vector_dim1);
-	//printf("Vector size 2: %lld\n", vector_dim2);	
+/* Write output rows [b, e) of one matrix into columns [col, col + dim) of the output. Blocks whose rows are
+   consecutive rows of the matrix are divided as a whole, other rows are gathered one by one. */
+static void WriteRows(const double *vec, long long rows, long long dim, const double *len, const double *fill_value,
+					const long long *output_rows, long long col, long long b, long long e)
+{
+	long long n = e - b, first = output_rows[b];
+	int aligned = first != -1 && first + n <= rows;
+	for (long long r = b; r != e && aligned; r++) aligned = output_rows[r] == first + (r - b);
+	for (long long c = 0; c != dim; c++)
+	{
+		double *out = output + (col + c) * num_output_rows;
+		const double *v = vec + c * rows;
+		if (aligned) SimdDivide(out + b, v + first, len + first, n);
+		else for (long long r = b; r != e; r++) out[r] = output_rows[r] == -1 ? fill_value[c] : v[output_rows[r]] / len[output_rows[r]];
+	}
 }
 
+/* Normalize output rows [begin, end) of both matrices and write them side by side into the output */
+static void ConcatenateTask(long long begin, long long end, void *arg)
+{
+	for (long long b = begin; b < end; b += ROW_BLOCK)
+	{
+		long long e = b + ROW_BLOCK < end ? b + ROW_BLOCK : end;
+		WriteRows(vec1, num_rows1, vector_dim1, len1, fill1, output_rows1, 0, b, e);
+		WriteRows(vec2, num_rows2, vector_dim2, len2, fill2, output_rows2, vector_dim1, b, e);
+	}
+}
 
-void ConcatenateMain(const std::vector<std::string> &first_order_vertices, const std::vector<std::string> &second_order_vertices, 
-					std::vector<std::string> &output_vertices, const std::vector< std::vector<double> > &first_order_features, 
-					const std::vector< std::vector<double> > &second_order_features, std::vector< std::vector<double> > &output_features, int binary_param = 0) {
+/* Normalize the rows of two column-major embedding matrices and write the output rows chosen by ConcatenateJoin
+   side by side into output, a column-major matrix. Where an output row has no row in one of the matrices its
+   columns get NaN, zero or the mean normalized row of that matrix, depending on fill. */
+void ConcatenateMain(const double *first_order_features, long long first_order_rows, long long first_order_dim,
+					const double *second_order_features, long long second_order_rows, long long second_order_dim,
+					const long long *output_first_rows, const long long *output_second_rows, long long output_rows,
+					double *output_features, int fill_param, int binary_param, int num_threads) {
+	TRACE_SCOPE("ConcatenateMain");
 	binary = binary_param;
-	long long a, b;
-	double len;
-
-	InitHashTable();
-	InitVectors(first_order_vertices, second_order_vertices, first_order_features, second_order_features);
-	//printf("%lld %lld\n", num_vertices, vector_dim1 + vector_dim2);
-	for (a = 0; a < num_vertices; a++) {
-		output_vertices.push_back(std::string(vertex[a].name));
-		len = 0;
-		for (b = 0; b < vector_dim1; b++) len += vec1[b + a * vector_dim1] * vec1[b + a * vector_dim1];
-		len = sqrt(len);
-		for (b = 0; b < vector_dim1; b++) vec1[b + a * vector_dim1] /= len;
-
-		len = 0;
-		for (b = 0; b < vector_dim2; b++) len += vec2[b + a * vector_dim2] * vec2[b + a * vector_dim2];
-		len = sqrt(len);
-		for (b = 0; b < vector_dim2; b++) vec2[b + a * vector_dim2] /= len;
+	fill = fill_param;
+	num_rows1 = first_order_rows;
+	num_rows2 = second_order_rows;
+	vector_dim1 = first_order_dim;
+	vector_dim2 = second_order_dim;
+	vec1 = first_order_features;
+	vec2 = second_order_features;
+	output_rows1 = output_first_rows;
+	output_rows2 = output_second_rows;
+	num_output_rows = output_rows;
+	output = output_features;
 
-		std::vector<double> v;
-		for (b = 0; b < vector_dim1; b++)
-			v.push_back(vec1[a * vector_dim1 + b]);
-		for (b = 0; b < vector_dim2; b++)
-			v.push_back(vec2[a * vector_dim2 + b]);	
-		output_features.push_back(v);
+	PerfCounters pc;
+	PerfReset();
+	PerfStart(&pc, "concatenate");
+	//printf("%lld %lld\n", num_output_rows, vector_dim1 + vector_dim2);
+	len1 = (double *)ScratchAlloc((num_rows1 + 1) * sizeof(double));
+	len2 = (double *)ScratchAlloc((num_rows2 + 1) * sizeof(double));
+	fill1 = (double *)ScratchAlloc((vector_dim1 + 1) * sizeof(double));
+	fill2 = (double *)ScratchAlloc((vector_dim2 + 1) * sizeof(double));
+	ParallelFor(num_rows1, ROW_BLOCK, num_threads, FirstOrderNormsTask, NULL);
+	ParallelFor(num_rows2, ROW_BLOCK, num_threads, SecondOrderNormsTask, NULL);
+	if (fill == CONCATENATE_FILL_MEAN)
+	{
+		ParallelFor(vector_dim1, 1, num_threads, FirstOrderMeansTask, NULL);
+		ParallelFor(vector_dim2, 1, num_threads, SecondOrderMeansTask, NULL);
+	}
+	else
+	{
+		for (long long c = 0; c != vector_dim1; c++) fill1[c] = fill == CONCATENATE_FILL_ZERO ? 0 : NAN;
+		for (long long c = 0; c != vector_dim2; c++) fill2[c] = fill == CONCATENATE_FILL_ZERO ? 0 : NAN;
 	}
+	ParallelFor(num_output_rows, ROW_BLOCK, num_threads, ConcatenateTask, NULL);
+	ArenaRelease(&scratch);
+	len1 = len2 = fill1 = fill2 = NULL;
+	PerfStop(&pc);
+	PerfPrint();
 }
 
 /*static void OutputVectors(std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_features) {
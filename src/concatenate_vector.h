@@ -1,12 +1,16 @@
 #include <vector>
-#include <string>
 
 #ifndef CONCATENATE_H
 #define CONCATENATE_H
 
-void ConcatenateMain(const std::vector<std::string> &first_order_vertices, const std::vector<std::string> &second_order_vertices, 
-					std::vector<std::string> &output_vertices, const std::vector< std::vector<double> > &first_order_features, 
-					const std::vector< std::vector<double> > &second_order_features, std::vector< std::vector<double> > &output_features, int binary_param = 0);
-#endif
+enum ConcatenateJoinType { CONCATENATE_JOIN_LEFT = 0, CONCATENATE_JOIN_INNER, CONCATENATE_JOIN_OUTER };
+enum ConcatenateFill { CONCATENATE_FILL_NAN = 0, CONCATENATE_FILL_ZERO, CONCATENATE_FILL_MEAN };
 
+int ConcatenateJoin(const char **first_order_vertices, long long first_order_rows, const char **second_order_vertices, long long second_order_rows,
+					int join, std::vector<long long> &output_first_rows, std::vector<long long> &output_second_rows, int num_threads = 1);
+void ConcatenateMain(const double *first_order_features, long long first_order_rows, long long first_order_dim,
+					const double *second_order_features, long long second_order_rows, long long second_order_dim,
+					const long long *output_first_rows, const long long *output_second_rows, long long output_rows,
+					double *output_features, int fill_param = 0, int binary_param = 0, int num_threads = 1);
+#endif
 
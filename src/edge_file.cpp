@@ -0,0 +1,209 @@
+/*
+Binary edge files: a header, the edges as packed (source, target, weight) records of two 32-bit
+vertex ids and a 32-bit float, and a table of the vertex names after them.
+
+The records are used as they are in the file, which is mapped read only, so reading an edge
+list costs no parsing and no interning: line and reconstruct copy the ids straight into their
+edge arrays. EdgeFileOpen checks once that every id is in the name table, so that the readers do
+not have to.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "edge_file.h"
+#include "trace.h"
+
+// Bumped whenever the file layout changes
+static const char edge_file_magic[8] = { 'R', 'L', 'E', 'D', 'G', 'E', 'S', 0 };
+static const uint32_t edge_file_version = 1, edge_file_byte_order = 0x01020304;
+
+struct EdgeFileHeader {
+	char magic[8];
+	uint32_t version, byte_order;
+	int64_t num_vertices, num_edges;
+	int64_t edges_offset, names_offset, names_bytes;
+	int64_t file_bytes;
+};
+
+static void Unmap(void *base, size_t bytes)
+{
+#ifndef _WIN32
+	munmap(base, bytes);
+#else
+	free(base);
+#endif
+}
+
+/* Map a binary edge file; returns NULL with a description in *error if it cannot be used */
+EdgeFile *EdgeFileOpen(const char *file, const char **error)
+{
+	TRACE_SCOPE("EdgeFileOpen");
+	*error = "cannot be read";
+	size_t file_bytes;
+	char *base;
+#ifndef _WIN32
+	int fd = open(file, O_RDONLY);
+	if (fd < 0) return NULL;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(EdgeFileHeader))
+	{
+		close(fd);
+		*error = "is not a binary edge file";
+		return NULL;
+	}
+	file_bytes = st.st_size;
+	base = (char *)mmap(NULL, file_bytes, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) return NULL;
+#else
+	// Without mmap the file is read into memory
+	FILE *fi = fopen(file, "rb");
+	if (fi == NULL) return NULL;
+	fseek(fi, 0, SEEK_END);
+	file_bytes = ftell(fi);
+	fseek(fi, 0, SEEK_SET);
+	base = (char *)malloc(file_bytes + 1);
+	int complete = base != NULL && fread(base, 1, file_bytes, fi) == file_bytes;
+	fclose(fi);
+	if (!complete || file_bytes < sizeof(EdgeFileHeader))
+	{
+		free(base);
+		*error = "is not a binary edge file";
+		return NULL;
+	}
+#endif
+
+	const EdgeFileHeader *h = (const EdgeFileHeader *)base;
+	int64_t V = h->num_vertices, E = h->num_edges;
+	*error = NULL;
+	if (memcmp(h->magic, edge_file_magic, sizeof(edge_file_magic)) != 0) *error = "is not a binary edge file";
+	else if (h->byte_order != edge_file_byte_order) *error = "was written on a machine of the other byte order";
+	else if (h->version != edge_file_version) *error = "was written by another version of rline";
+	else if (h->file_bytes != (int64_t)file_bytes) *error = "is truncated";
+	else if (V < 0 || V > INT32_MAX || E < 0 || h->edges_offset != (int64_t)sizeof(EdgeFileHeader) ||
+	         h->names_offset != h->edges_offset + E * (int64_t)sizeof(EdgeRecord) || h->names_bytes < 0 ||
+	         h->names_offset + h->names_bytes != h->file_bytes)
+		*error = "has a corrupt header";
+	EdgeFile *edge_file = *error == NULL ? (EdgeFile *)calloc(1, sizeof(EdgeFile)) : NULL;
+	if (edge_file != NULL) edge_file->names = (const char **)malloc(V * sizeof(const char *) + 1);
+	if (edge_file == NULL || edge_file->names == NULL)
+	{
+		if (*error == NULL) *error = "cannot be opened, memory allocation failed";
+		if (edge_file != NULL) free(edge_file);
+		Unmap(base, file_bytes);
+		return NULL;
+	}
+	edge_file->num_vertices = V;
+	edge_file->num_edges = E;
+	edge_file->edges = (const EdgeRecord *)(base + h->edges_offset);
+	edge_file->mapping = base;
+	edge_file->mapping_bytes = file_bytes;
+
+	// Every name ends with a terminator, and every id has a name
+	const char *name = base + h->names_offset, *end = name + h->names_bytes;
+	for (int64_t k = 0; k != V && *error == NULL; k++)
+	{
+		const char *terminator = name < end ? (const char *)memchr(name, 0, end - name) : NULL;
+		if (terminator == NULL) *error = "has a corrupt name table";
+		else
+		{
+			edge_file->names[k] = name;
+			name = terminator + 1;
+		}
+	}
+	for (int64_t e = 0; e != E && *error == NULL; e++)
+	{
+		const EdgeRecord &r = edge_file->edges[e];
+		if (r.source < 0 || r.source >= V || r.target < 0 || r.target >= V) *error = "has an edge between vertices that are not in its name table";
+	}
+	if (*error != NULL)
+	{
+		EdgeFileClose(edge_file);
+		return NULL;
+	}
+	return edge_file;
+}
+
+void EdgeFileClose(EdgeFile *edge_file)
+{
+	if (edge_file == NULL) return;
+	Unmap(edge_file->mapping, edge_file->mapping_bytes);
+	free(edge_file->names);
+	free(edge_file);
+}
+
+/* Average vertex name length, estimated from the first names */
+double EdgeFileNameLength(const EdgeFile &edge_file)
+{
+	long long n = edge_file.num_vertices < 10000 ? edge_file.num_vertices : 10000, length = 0;
+	for (long long k = 0; k != n; k++) length += strlen(edge_file.names[k]);
+	return n == 0 ? 0 : (double)length / n;
+}
+
+/* Start writing a binary edge file: the edges are appended first, then the names of the vertices
+   in id order. file is only replaced by EdgeFileEnd, so it may be mapped meanwhile. Returns 0 if
+   the file cannot be created. */
+int EdgeFileBegin(EdgeFileWriter *writer, const char *file)
+{
+	EdgeFileHeader header;
+	memset(&header, 0, sizeof(header));
+	writer->num_vertices = writer->num_edges = writer->names_bytes = 0;
+	writer->fo = ReplaceFileOpen(&writer->replace, file);
+	writer->ok = writer->fo != NULL && fwrite(&header, sizeof(header), 1, writer->fo) == 1;
+	if (!writer->ok) EdgeFileAbort(writer);
+	return writer->ok;
+}
+
+void EdgeFileAppend(EdgeFileWriter *writer, long long source, long long target, double weight)
+{
+	EdgeRecord record;
+	record.source = (int32_t)source;
+	record.target = (int32_t)target;
+	record.weight = (float)weight;
+	if (writer->ok) writer->ok = fwrite(&record, sizeof(record), 1, writer->fo) == 1;
+	writer->num_edges++;
+}
+
+void EdgeFileAppendName(EdgeFileWriter *writer, const char *name)
+{
+	size_t length = strlen(name) + 1;
+	if (writer->ok) writer->ok = fwrite(name, 1, length, writer->fo) == length;
+	writer->names_bytes += length;
+	writer->num_vertices++;
+}
+
+/* Write the header and replace the file with the new one; returns 0, leaving the file as it was,
+   if any write failed */
+int EdgeFileEnd(EdgeFileWriter *writer)
+{
+	if (writer->fo == NULL) return 0;
+	EdgeFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, edge_file_magic, sizeof(edge_file_magic));
+	header.version = edge_file_version;
+	header.byte_order = edge_file_byte_order;
+	header.num_vertices = writer->num_vertices;
+	header.num_edges = writer->num_edges;
+	header.edges_offset = sizeof(header);
+	header.names_offset = header.edges_offset + writer->num_edges * (int64_t)sizeof(EdgeRecord);
+	header.names_bytes = writer->names_bytes;
+	header.file_bytes = header.names_offset + header.names_bytes;
+	int ok = writer->ok && fseek(writer->fo, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, writer->fo) == 1;
+	writer->fo = NULL;
+	return ReplaceFileClose(&writer->replace, ok);
+}
+
+/* Stop writing and leave the file as it was */
+void EdgeFileAbort(EdgeFileWriter *writer)
+{
+	writer->fo = NULL;
+	ReplaceFileClose(&writer->replace, 0);
+}
@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "replace_file.h"
+
+#ifndef EDGE_FILE_H
+#define EDGE_FILE_H
+
+// One directed edge of a binary edge file, 12 bytes packed
+struct EdgeRecord {
+	int32_t source, target;
+	float weight;
+};
+
+// A binary edge file mapped into memory: num_edges records of vertex ids into a table of
+// num_vertices names
+struct EdgeFile {
+	long long num_vertices, num_edges;
+	const EdgeRecord *edges;
+	const char **names;
+	void *mapping;
+	size_t mapping_bytes;
+};
+
+// Writes a binary edge file record by record, the names last, under a temporary name until EdgeFileEnd
+struct EdgeFileWriter {
+	ReplaceFile replace;
+	FILE *fo;
+	long long num_vertices, num_edges, names_bytes;
+	int ok;
+};
+
+EdgeFile *EdgeFileOpen(const char *file, const char **error);
+void EdgeFileClose(EdgeFile *edge_file);
+double EdgeFileNameLength(const EdgeFile &edge_file);
+int EdgeFileBegin(EdgeFileWriter *writer, const char *file);
+void EdgeFileAppend(EdgeFileWriter *writer, long long source, long long target, double weight);
+void EdgeFileAppendName(EdgeFileWriter *writer, const char *name);
+int EdgeFileEnd(EdgeFileWriter *writer);
+void EdgeFileAbort(EdgeFileWriter *writer);
+#endif
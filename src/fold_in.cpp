@@ -0,0 +1,189 @@
+/*
+Fold-in of new vertices into a trained LINE embedding without retraining.
+
+Only the edges that touch a new vertex are trained, with LINE's edge sampling, negative
+sampling and update. The rows of the existing vertices, and the context rows for the second
+order, are frozen: an update whose target row is frozen only moves the source row, and the
+error of a frozen source is dropped. Negatives are drawn from all vertices by their degree in
+the training graph and the fold-in edges, as line draws them, or uniformly when the training
+graph is not given.
+
+The rows are copied to float, row-major, with the new vertices after the existing ones.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <R.h>
+#include "line_kernel.h"
+#include "sampling.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "parallel.h"
+#include "memory_planner.h"
+#include "fold_in.h"
+
+static int order = 2, dim = 100, num_negative = 5, num_threads = 1;
+static long long num_total = 0, num_edges = 0, total_samples = 0, neg_table_size = 0;
+static real init_rho = 0.025;
+static real *emb_vertex, *emb_context, *sigmoid_table;
+static char *is_new;
+static long long *alias;
+static const int *edge_source_id, *edge_target_id;
+static int *neg_table;
+static double *prob;
+static const double *vertex_degree;
+static unsigned long long *thread_seeds;
+
+static void FreeFoldIn()
+{
+	free(emb_vertex); emb_vertex = NULL;
+	free(emb_context); emb_context = NULL;
+	free(sigmoid_table); sigmoid_table = NULL;
+	free(is_new); is_new = NULL;
+	free(alias); alias = NULL;
+	free(neg_table); neg_table = NULL;
+	free(prob); prob = NULL;
+	free(thread_seeds); thread_seeds = NULL;
+}
+
+static double Degree(long long k)
+{
+	return vertex_degree[k];
+}
+
+static double UnitDegree(long long k)
+{
+	return 1;
+}
+
+static void FoldInThread(long long begin, long long end, void *arg)
+{
+	real *vec_error = (real *)calloc(dim, sizeof(real));
+	for (long long id = begin; id != end; id++)
+	{
+		unsigned long long seed = thread_seeds[id];
+		long long samples = total_samples / num_threads;
+		real rho = init_rho;
+		PerfCounters pc;
+		PerfStart(&pc, "fold in thread", (int)id);
+		TraceThreadName("fold in thread");
+
+		for (long long count = 0; count != samples; count++)
+		{
+			if (count % 10000 == 0)
+			{
+				rho = init_rho * (1 - count / (real)(samples + 1));
+				if (rho < init_rho * 0.0001) rho = init_rho * 0.0001;
+			}
+
+			long long curedge = SampleAlias(prob, alias, num_edges, FastUniform(seed), FastUniform(seed));
+			long long u = edge_source_id[curedge], v = edge_target_id[curedge];
+			real *vec_u = &emb_vertex[u * dim];
+			for (int c = 0; c != dim; c++) vec_error[c] = 0;
+
+			for (int d = 0; d != num_negative + 1; d++)
+			{
+				long long target = d == 0 ? v : neg_table[FastRand(seed, neg_table_size)];
+				int label = d == 0 ? 1 : 0;
+				real *vec_v = order == 1 ? &emb_vertex[target * dim] : &emb_context[target * dim];
+				if (is_new[target]) Update(vec_u, vec_v, vec_error, label, dim, rho, sigmoid_table);
+				else if (is_new[u]) UpdateSource(vec_u, vec_v, vec_error, label, dim, rho, sigmoid_table);
+			}
+			if (is_new[u]) for (int c = 0; c != dim; c++) vec_u[c] += vec_error[c];
+		}
+		PerfStop(&pc);
+	}
+	free(vec_error);
+}
+
+/* Train num_new new vertices, ids num_existing and up, on the given edges between new and
+   existing vertices, keeping the column-major num_existing x dim vertex (and for order 2
+   context) rows frozen. degree holds the weighted degree of every vertex, or is NULL for uniform
+   negatives. Writes column-major num_new x dim rows; returns 0 if out of memory. */
+int FoldInMain(const double *vertex_features, const double *context_features, long long num_existing, long long num_new, int dim_param,
+               const int *source, const int *target, const double *weight, long long num_edges_param, const double *degree,
+               int order_param, int num_negative_param, double samples_param, float init_rho_param, int num_threads_param,
+               double *output_vertex, double *output_context)
+{
+	TRACE_SCOPE("FoldInMain");
+	PerfReset();
+	dim = dim_param;
+	order = order_param;
+	num_negative = num_negative_param;
+	total_samples = (long long)(samples_param * 1000000);
+	init_rho = init_rho_param;
+	num_threads = num_threads_param < 1 ? 1 : num_threads_param;
+	num_edges = num_edges_param;
+	num_total = num_existing + num_new;
+	edge_source_id = source;
+	edge_target_id = target;
+	vertex_degree = degree;
+
+	neg_table_size = 100 * num_total;
+	if (neg_table_size < min_neg_table_size) neg_table_size = min_neg_table_size;
+	if (neg_table_size > default_neg_table_size) neg_table_size = default_neg_table_size;
+	emb_vertex = (real *)malloc(num_total * dim * sizeof(real) + 1);
+	if (order == 2) emb_context = (real *)malloc(num_total * dim * sizeof(real) + 1);
+	sigmoid_table = (real *)malloc((sigmoid_table_size + 1) * sizeof(real));
+	is_new = (char *)malloc(num_total + 1);
+	alias = (long long *)malloc(num_edges * sizeof(long long) + 1);
+	prob = (double *)malloc(num_edges * sizeof(double) + 1);
+	neg_table = (int *)malloc(neg_table_size * sizeof(int));
+	thread_seeds = (unsigned long long *)malloc(num_threads * sizeof(unsigned long long));
+	if (emb_vertex == NULL || (order == 2 && emb_context == NULL) || sigmoid_table == NULL || is_new == NULL ||
+	    alias == NULL || prob == NULL || neg_table == NULL || thread_seeds == NULL ||
+	    (num_edges > 0 && !FillAliasTable(weight, num_edges, alias, prob)))
+	{
+		Rprintf("Error: memory allocation failed\n");
+		FreeFoldIn();
+		return 0;
+	}
+
+	PerfCounters pc;
+	PerfStart(&pc, "fold in setup");
+	for (long long k = 0; k != num_existing; k++)
+	{
+		is_new[k] = 0;
+		for (int c = 0; c != dim; c++)
+		{
+			emb_vertex[k * dim + c] = (real)vertex_features[c * num_existing + k];
+			if (order == 2) emb_context[k * dim + c] = (real)context_features[c * num_existing + k];
+		}
+	}
+	GetRNGstate();
+	for (long long k = num_existing; k != num_total; k++)
+	{
+		is_new[k] = 1;
+		for (int c = 0; c != dim; c++)
+		{
+			emb_vertex[k * dim + c] = (unif_rand() - 0.5) / dim;
+			if (order == 2) emb_context[k * dim + c] = 0;
+		}
+	}
+	for (int a = 0; a != num_threads; a++) thread_seeds[a] = (unsigned long long)(unif_rand() * 4294967296.0) + a;
+	PutRNGstate();
+	double sum = 0;
+	for (long long k = 0; degree != NULL && k != num_total; k++) sum += degree[k];
+	if (sum > 0) FillNegTable(neg_table, neg_table_size, num_total, Degree);
+	else FillNegTable(neg_table, neg_table_size, num_total, UnitDegree);
+	InitSigmoidTable(sigmoid_table);
+	PerfStop(&pc);
+
+	if (num_edges > 0)
+	{
+		PerfStart(&pc, "fold in train");
+		ParallelFor(num_threads, 1, num_threads, FoldInThread, NULL);
+		PerfStop(&pc);
+	}
+	PerfPrint();
+
+	for (long long k = 0; k != num_new; k++)
+		for (int c = 0; c != dim; c++)
+		{
+			output_vertex[c * num_new + k] = emb_vertex[(num_existing + k) * dim + c];
+			if (order == 2 && output_context != NULL) output_context[c * num_new + k] = emb_context[(num_existing + k) * dim + c];
+		}
+	FreeFoldIn();
+	return 1;
+}
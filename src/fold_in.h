@@ -0,0 +1,8 @@
+#ifndef FOLD_IN_H
+#define FOLD_IN_H
+
+int FoldInMain(const double *vertex_features, const double *context_features, long long num_existing, long long num_new, int dim_param,
+               const int *source, const int *target, const double *weight, long long num_edges_param, const double *degree,
+               int order_param, int num_negative_param, double samples_param, float init_rho_param, int num_threads_param,
+               double *output_vertex, double *output_context);
+#endif
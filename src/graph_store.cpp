@@ -0,0 +1,507 @@
+/*
+Native graph objects that outlive a single call.
+
+The vertex names of an edge list are interned once, in the order line would number them, into
+a name arena and a hash table that stays with the graph, and the edges are stored as compressed
+sparse columns, the layout reconstruct and line read a dgCMatrix in. Every later call reads the
+arrays in place, and looks names up in the stored table instead of building its own.
+
+GraphSave writes all of it, and optionally line's alias table of the edges, to a file laid out
+to be mapped: a header, then every array at an offset aligned to a cache line, in exactly the
+layout it has in memory. GraphLoad maps the file read only and points the graph at it, so a
+graph of any size loads in the time it takes to build the array of name pointers, and every
+process that loads the same file shares its pages in the page cache. The header carries a
+format version and a checksum of itself and of the arrays. The column pointers are 64-bit, so a
+graph may have any number of edges, but at most 2^31 - 1 vertices.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <climits>
+#include <vector>
+#include <R.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "graph_store.h"
+#include "replace_file.h"
+#include "sampling.h"
+#include "perf_counters.h"
+#include "trace.h"
+
+// Bumped whenever the file layout of GraphSave changes
+static const char graph_magic[8] = { 'R', 'L', 'G', 'R', 'A', 'P', 'H', 0 };
+static const uint32_t graph_version = 2, graph_byte_order = 0x01020304;
+#define GRAPH_SECTION_ALIGNMENT 64
+#define GRAPH_FILE_ALIAS 1              // flag: the file has an alias table of the edges
+
+enum GraphSection { GRAPH_COL_PTR = 0, GRAPH_ROW, GRAPH_WEIGHT, GRAPH_NAME_OFFSET, GRAPH_NAMES, GRAPH_TABLE, GRAPH_ALIAS,
+	GRAPH_PROB, GRAPH_NUM_SECTIONS };
+
+struct GraphFileHeader {
+	char magic[8];
+	uint32_t version, byte_order, flags, reserved;
+	int64_t num_vertices, num_edges, name_bytes, table_size;
+	int64_t offset[GRAPH_NUM_SECTIONS], bytes[GRAPH_NUM_SECTIONS];
+	int64_t file_bytes;
+	uint64_t checksum;                     // of everything after the header
+	uint64_t header_checksum;              // of the header up to here
+};
+
+/* FNV-1a hash of a vertex name */
+static unsigned long long Hash(const char *key)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	while (*key)
+	{
+		hash ^= (unsigned char)(*key++);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static void Insert(long long *table, unsigned long long mask, const char *name, long long id)
+{
+	unsigned long long addr = Hash(name) & mask;
+	while (table[addr] != -1) addr = (addr + 1) & mask;
+	table[addr] = id;
+}
+
+long long GraphFind(const GraphStore *store, const char *name)
+{
+	unsigned long long addr = Hash(name) & store->mask;
+	while (store->table[addr] != -1)
+	{
+		if (!strcmp(store->names[store->table[addr]], name)) return store->table[addr];
+		addr = (addr + 1) & store->mask;
+	}
+	return -1;
+}
+
+/* Double the hash table once it is half full, and the name array with it */
+static int Grow(GraphStore *store, long long num_vertices)
+{
+	unsigned long long size = (store->mask + 1) * 2;
+	long long *table = (long long *)malloc(size * sizeof(long long));
+	const char **names = (const char **)realloc(store->names, size / 2 * sizeof(const char *));
+	if (table == NULL || names == NULL)
+	{
+		free(table);
+		if (names != NULL) store->names = names;
+		return 0;
+	}
+	store->names = names;
+	for (unsigned long long k = 0; k != size; k++) table[k] = -1;
+	for (long long k = 0; k != num_vertices; k++) Insert(table, size - 1, names[k], k);
+	free(store->table);
+	store->table = table;
+	store->mask = size - 1;
+	return 1;
+}
+
+/* Id of name, added as a new vertex if it is not one yet; -1 if out of memory */
+static long long Intern(GraphStore *store, long long &num_vertices, const char *name)
+{
+	long long id = GraphFind(store, name);
+	if (id != -1) return id;
+	if (2 * (unsigned long long)(num_vertices + 1) > store->mask + 1 && !Grow(store, num_vertices)) return -1;
+	const char *copy = ArenaStrdup(&store->name_arena, name);
+	if (copy == NULL) return -1;
+	store->names[num_vertices] = copy;
+	Insert(store->table, store->mask, copy, num_vertices);
+	return num_vertices++;
+}
+
+/* Ingest the edges source[e] -> target[e] with weight[e]; returns NULL if out of memory or if the
+   vertices do not fit in the int rows of the compressed columns */
+GraphStore *GraphBuild(const char **source, const char **target, const double *weight, long long num_edges)
+{
+	TRACE_SCOPE("GraphBuild");
+	PerfReset();
+	GraphStore *store = (GraphStore *)calloc(1, sizeof(GraphStore));
+	if (store == NULL) return NULL;
+	Arena empty = ARENA_INIT;
+	store->name_arena = empty;
+	store->mask = 1023;
+	store->table = (long long *)malloc((store->mask + 1) * sizeof(long long));
+	store->names = (const char **)malloc((store->mask + 1) / 2 * sizeof(const char *));
+	long long *source_id = (long long *)malloc(num_edges * sizeof(long long) + 1);
+	long long *target_id = (long long *)malloc(num_edges * sizeof(long long) + 1);
+	if (store->table == NULL || store->names == NULL || source_id == NULL || target_id == NULL)
+	{
+		free(source_id);
+		free(target_id);
+		GraphFree(store);
+		return NULL;
+	}
+	for (unsigned long long k = 0; k <= store->mask; k++) store->table[k] = -1;
+
+	PerfCounters pc;
+	PerfStart(&pc, "graph intern");
+	long long num_vertices = 0;
+	int failed = 0;
+	for (long long e = 0; e != num_edges && !failed; e++)
+	{
+		source_id[e] = Intern(store, num_vertices, source[e]);
+		target_id[e] = Intern(store, num_vertices, target[e]);
+		failed = source_id[e] == -1 || target_id[e] == -1;
+	}
+	PerfStop(&pc);
+
+	PerfStart(&pc, "graph columns");
+	store->col_ptr = (long long *)calloc(num_vertices + 1, sizeof(long long));
+	store->row = (int *)malloc(num_edges * sizeof(int) + 1);
+	store->weight = (double *)malloc(num_edges * sizeof(double) + 1);
+	if (failed || num_vertices > INT_MAX || store->col_ptr == NULL || store->row == NULL || store->weight == NULL)
+	{
+		PerfStop(&pc);
+		free(source_id);
+		free(target_id);
+		GraphFree(store);
+		return NULL;
+	}
+	// Counting sort of the edges by target, which keeps the order of the edges into every vertex
+	for (long long e = 0; e != num_edges; e++) store->col_ptr[target_id[e] + 1]++;
+	for (long long k = 0; k != num_vertices; k++) store->col_ptr[k + 1] += store->col_ptr[k];
+	std::vector<long long> next(store->col_ptr, store->col_ptr + num_vertices);
+	for (long long e = 0; e != num_edges; e++)
+	{
+		long long k = next[target_id[e]]++;
+		store->row[k] = (int)source_id[e];
+		store->weight[k] = weight[e];
+	}
+	free(source_id);
+	free(target_id);
+	PerfStop(&pc);
+	PerfPrint();
+
+	CompressedGraph graph = { num_vertices, num_edges, store->col_ptr, store->row, store->weight, store->names };
+	store->graph = graph;
+	return store;
+}
+
+/* Checksum of a stream of bytes, eight at a time */
+struct Checksum {
+	uint64_t hash;
+	unsigned char carry[8];
+	int num_carry;
+};
+
+static inline uint64_t Mix(uint64_t hash, uint64_t word)
+{
+	hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+	return hash ^ (hash >> 29);
+}
+
+static void ChecksumInit(Checksum *c)
+{
+	c->hash = 14695981039346656037ULL;
+	c->num_carry = 0;
+}
+
+static void ChecksumUpdate(Checksum *c, const void *data, size_t bytes)
+{
+	const unsigned char *p = (const unsigned char *)data;
+	while (bytes > 0 && c->num_carry != 0)
+	{
+		c->carry[c->num_carry++] = *p++;
+		bytes--;
+		if (c->num_carry == 8)
+		{
+			uint64_t word;
+			memcpy(&word, c->carry, 8);
+			c->hash = Mix(c->hash, word);
+			c->num_carry = 0;
+		}
+	}
+	for (; bytes >= 8; p += 8, bytes -= 8)
+	{
+		uint64_t word;
+		memcpy(&word, p, 8);
+		c->hash = Mix(c->hash, word);
+	}
+	while (bytes-- > 0) c->carry[c->num_carry++] = *p++;
+}
+
+static uint64_t ChecksumFinal(Checksum *c)
+{
+	uint64_t hash = c->hash;
+	if (c->num_carry != 0)
+	{
+		unsigned char last[8] = { 0 };
+		memcpy(last, c->carry, c->num_carry);
+		uint64_t word;
+		memcpy(&word, last, 8);
+		hash = Mix(hash, word);
+	}
+	return Mix(hash, 0);
+}
+
+// Sections are written one after the other, each padded to GRAPH_SECTION_ALIGNMENT
+struct GraphWriter {
+	FILE *fo;
+	int64_t offset;
+	Checksum checksum;
+	int ok;
+};
+
+static void WriteBytes(GraphWriter *w, const void *data, int64_t bytes)
+{
+	if (bytes > 0 && w->ok) w->ok = fwrite(data, 1, bytes, w->fo) == (size_t)bytes;
+	ChecksumUpdate(&w->checksum, data, bytes);
+	w->offset += bytes;
+}
+
+/* Pad the section that started at header->offset[section] to the alignment */
+static void EndSection(GraphWriter *w, GraphFileHeader *header, int section)
+{
+	static const char padding[GRAPH_SECTION_ALIGNMENT] = { 0 };
+	header->bytes[section] = w->offset - header->offset[section];
+	WriteBytes(w, padding, (GRAPH_SECTION_ALIGNMENT - w->offset % GRAPH_SECTION_ALIGNMENT) % GRAPH_SECTION_ALIGNMENT);
+}
+
+static void WriteSection(GraphWriter *w, GraphFileHeader *header, int section, const void *data, int64_t bytes)
+{
+	header->offset[section] = w->offset;
+	WriteBytes(w, data, bytes);
+	EndSection(w, header, section);
+}
+
+static uint64_t HeaderChecksum(const GraphFileHeader *header)
+{
+	Checksum c;
+	ChecksumInit(&c);
+	ChecksumUpdate(&c, header, offsetof(GraphFileHeader, header_checksum));
+	return ChecksumFinal(&c);
+}
+
+/* Write the graph to file, with line's alias table of the edges if with_alias; returns 0 if the
+   file cannot be written or the alias table cannot be built. The graph may be mapped from file
+   itself, which is only replaced once the new one is complete. */
+int GraphSave(const GraphStore *store, const char *file, int with_alias)
+{
+	TRACE_SCOPE("GraphSave");
+	const CompressedGraph &graph = store->graph;
+	long long V = graph.num_vertices, E = graph.num_edges;
+	std::vector<int64_t> name_offset(V + 1, 0);
+	for (long long k = 0; k != V; k++) name_offset[k + 1] = name_offset[k] + strlen(graph.names[k]) + 1;
+	int64_t alias_size = GraphAliasIsInt(E) ? sizeof(int) : sizeof(long long);
+	void *alias = NULL;
+	double *prob = NULL;
+	if (with_alias && E > 0)
+	{
+		alias = malloc(E * alias_size);
+		prob = (double *)malloc(E * sizeof(double));
+		int filled = alias != NULL && prob != NULL &&
+			(GraphAliasIsInt(E) ? FillAliasTable(graph.weight, E, (int *)alias, prob) : FillAliasTable(graph.weight, E, (long long *)alias, prob));
+		if (!filled)
+		{
+			free(alias);
+			free(prob);
+			return 0;
+		}
+	}
+	ReplaceFile replace;
+	FILE *fo = ReplaceFileOpen(&replace, file);
+	if (fo == NULL)
+	{
+		free(alias);
+		free(prob);
+		return 0;
+	}
+
+	GraphFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, graph_magic, sizeof(graph_magic));
+	header.version = graph_version;
+	header.byte_order = graph_byte_order;
+	header.flags = with_alias ? GRAPH_FILE_ALIAS : 0;
+	header.num_vertices = V;
+	header.num_edges = E;
+	header.name_bytes = name_offset[V];
+	header.table_size = store->mask + 1;
+	GraphWriter w;
+	w.fo = fo;
+	w.offset = sizeof(header);
+	w.ok = fwrite(&header, sizeof(header), 1, fo) == 1;
+	ChecksumInit(&w.checksum);
+	// The arrays start on an aligned offset too
+	static const char padding[GRAPH_SECTION_ALIGNMENT] = { 0 };
+	WriteBytes(&w, padding, (GRAPH_SECTION_ALIGNMENT - w.offset % GRAPH_SECTION_ALIGNMENT) % GRAPH_SECTION_ALIGNMENT);
+	WriteSection(&w, &header, GRAPH_COL_PTR, graph.col_ptr, (V + 1) * sizeof(long long));
+	WriteSection(&w, &header, GRAPH_ROW, graph.row, E * sizeof(int));
+	WriteSection(&w, &header, GRAPH_WEIGHT, graph.weight, E * sizeof(double));
+	WriteSection(&w, &header, GRAPH_NAME_OFFSET, &name_offset[0], (V + 1) * sizeof(int64_t));
+	header.offset[GRAPH_NAMES] = w.offset;
+	for (long long k = 0; k != V; k++) WriteBytes(&w, graph.names[k], name_offset[k + 1] - name_offset[k]);
+	EndSection(&w, &header, GRAPH_NAMES);
+	WriteSection(&w, &header, GRAPH_TABLE, store->table, (store->mask + 1) * sizeof(long long));
+	WriteSection(&w, &header, GRAPH_ALIAS, alias, alias != NULL ? E * alias_size : 0);
+	WriteSection(&w, &header, GRAPH_PROB, prob, prob != NULL ? E * sizeof(double) : 0);
+	free(alias);
+	free(prob);
+
+	header.file_bytes = w.offset;
+	header.checksum = ChecksumFinal(&w.checksum);
+	header.header_checksum = HeaderChecksum(&header);
+	int ok = w.ok && fseek(fo, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, fo) == 1;
+	return ReplaceFileClose(&replace, ok);
+}
+
+static const char *GraphFileError(const GraphFileHeader *h, int64_t file_bytes)
+{
+	if (memcmp(h->magic, graph_magic, sizeof(graph_magic)) != 0) return "is not an rline graph";
+	if (h->byte_order != graph_byte_order) return "was written on a machine of the other byte order";
+	if (h->version != graph_version) return "was written by another version of rline";
+	if (h->header_checksum != HeaderChecksum(h)) return "has a corrupt header";
+	if (h->file_bytes != file_bytes) return "is truncated";
+	int64_t V = h->num_vertices, E = h->num_edges;
+	if (V < 0 || V > INT_MAX || E < 0 || E > LLONG_MAX / (int64_t)sizeof(double) || h->table_size < 2 * V ||
+	    h->table_size > LLONG_MAX / (int64_t)sizeof(long long) || (h->table_size & (h->table_size - 1)) != 0)
+		return "has a corrupt header";
+	int alias = (h->flags & GRAPH_FILE_ALIAS) != 0 && E > 0;
+	int64_t alias_size = GraphAliasIsInt(E) ? sizeof(int) : sizeof(long long);
+	int64_t expected[GRAPH_NUM_SECTIONS] = { (V + 1) * (int64_t)sizeof(long long), E * (int64_t)sizeof(int), E * (int64_t)sizeof(double),
+		(V + 1) * (int64_t)sizeof(int64_t), h->name_bytes, h->table_size * (int64_t)sizeof(long long),
+		alias ? E * alias_size : 0, alias ? E * (int64_t)sizeof(double) : 0 };
+	for (int s = 0; s != GRAPH_NUM_SECTIONS; s++)
+		if (h->bytes[s] != expected[s] || h->offset[s] < (int64_t)sizeof(GraphFileHeader) ||
+		    h->offset[s] % GRAPH_SECTION_ALIGNMENT != 0 || h->offset[s] + h->bytes[s] > file_bytes)
+			return "has a corrupt header";
+	return NULL;
+}
+
+/* Map a file written by GraphSave. Checks the header, and the checksum of the arrays too if verify,
+   which reads the whole file. Returns NULL with a description in *error if the file cannot be used. */
+GraphStore *GraphLoad(const char *file, int verify, const char **error)
+{
+	TRACE_SCOPE("GraphLoad");
+	*error = "cannot be read";
+	size_t file_bytes;
+	char *base;
+#ifndef _WIN32
+	int fd = open(file, O_RDONLY);
+	if (fd < 0) return NULL;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(GraphFileHeader))
+	{
+		close(fd);
+		*error = "is not an rline graph";
+		return NULL;
+	}
+	file_bytes = st.st_size;
+	base = (char *)mmap(NULL, file_bytes, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) return NULL;
+#else
+	// Without mmap the file is read into memory
+	FILE *fi = fopen(file, "rb");
+	if (fi == NULL) return NULL;
+	fseek(fi, 0, SEEK_END);
+	file_bytes = ftell(fi);
+	fseek(fi, 0, SEEK_SET);
+	base = (char *)malloc(file_bytes + 1);
+	int complete = base != NULL && fread(base, 1, file_bytes, fi) == file_bytes;
+	fclose(fi);
+	if (!complete || file_bytes < sizeof(GraphFileHeader))
+	{
+		free(base);
+		return NULL;
+	}
+#endif
+	GraphStore *store = (GraphStore *)calloc(1, sizeof(GraphStore));
+	if (store == NULL)
+	{
+		*error = "cannot be loaded, memory allocation failed";
+#ifndef _WIN32
+		munmap(base, file_bytes);
+#else
+		free(base);
+#endif
+		return NULL;
+	}
+	Arena empty = ARENA_INIT;
+	store->name_arena = empty;
+	store->mapping = base;
+	store->mapping_bytes = file_bytes;
+
+	const GraphFileHeader *h = (const GraphFileHeader *)base;
+	*error = GraphFileError(h, file_bytes);
+	if (*error == NULL && verify)
+	{
+		Checksum c;
+		ChecksumInit(&c);
+		ChecksumUpdate(&c, base + sizeof(GraphFileHeader), file_bytes - sizeof(GraphFileHeader));
+		if (ChecksumFinal(&c) != h->checksum) *error = "does not match its checksum";
+	}
+	if (*error != NULL)
+	{
+		GraphFree(store);
+		return NULL;
+	}
+
+	long long V = h->num_vertices;
+	const int64_t *name_offset = (const int64_t *)(base + h->offset[GRAPH_NAME_OFFSET]);
+	const char *names = base + h->offset[GRAPH_NAMES];
+	store->names = (const char **)malloc(V * sizeof(const char *) + 1);
+	if (store->names == NULL)
+	{
+		*error = "cannot be loaded, memory allocation failed";
+		GraphFree(store);
+		return NULL;
+	}
+	for (long long k = 0; k != V; k++)
+	{
+		if (name_offset[k] < 0 || name_offset[k] >= name_offset[k + 1] || name_offset[k + 1] > h->name_bytes ||
+		    names[name_offset[k + 1] - 1] != 0)
+		{
+			*error = "has a corrupt name table";
+			GraphFree(store);
+			return NULL;
+		}
+		store->names[k] = names + name_offset[k];
+	}
+	store->col_ptr = (long long *)(base + h->offset[GRAPH_COL_PTR]);
+	store->row = (int *)(base + h->offset[GRAPH_ROW]);
+	store->weight = (double *)(base + h->offset[GRAPH_WEIGHT]);
+	store->table = (long long *)(base + h->offset[GRAPH_TABLE]);
+	store->mask = h->table_size - 1;
+	CompressedGraph graph = { V, h->num_edges, store->col_ptr, store->row, store->weight, store->names };
+	if (h->bytes[GRAPH_ALIAS] > 0)
+	{
+		graph.alias = base + h->offset[GRAPH_ALIAS];
+		graph.prob = (const double *)(base + h->offset[GRAPH_PROB]);
+	}
+	store->graph = graph;
+	return store;
+}
+
+void GraphFree(GraphStore *store)
+{
+	if (store == NULL) return;
+	if (store->mapping != NULL)
+	{
+		// The arrays point into the mapping, only the name pointers are allocated
+#ifndef _WIN32
+		munmap(store->mapping, store->mapping_bytes);
+#else
+		free(store->mapping);
+#endif
+		free(store->names);
+		free(store);
+		return;
+	}
+	free(store->col_ptr);
+	free(store->row);
+	free(store->weight);
+	free(store->names);
+	free(store->table);
+	ArenaRelease(&store->name_arena);
+	free(store);
+}
@@ -0,0 +1,27 @@
+#include "arena.h"
+#include "compressed_graph.h"
+
+#ifndef GRAPH_STORE_H
+#define GRAPH_STORE_H
+
+// A graph ingested once and kept in native memory, so that reconstruct, line and concatenate can
+// run on it any number of times without interning its vertex names again
+struct GraphStore {
+	CompressedGraph graph;                 // view of the arrays below
+	long long *col_ptr;                    // compressed sparse columns: edges into every vertex
+	int *row;
+	double *weight;
+	const char **names;                    // vertex names in order of first appearance, in name_arena
+	Arena name_arena;
+	long long *table;                      // open addressing hash table from names to vertex ids, -1 if empty
+	unsigned long long mask;
+	void *mapping;                         // file the arrays are mapped from by GraphLoad, or NULL
+	size_t mapping_bytes;
+};
+
+GraphStore *GraphBuild(const char **source, const char **target, const double *weight, long long num_edges);
+long long GraphFind(const GraphStore *store, const char *name);
+int GraphSave(const GraphStore *store, const char *file, int with_alias);
+GraphStore *GraphLoad(const char *file, int verify, const char **error);
+void GraphFree(GraphStore *store);
+#endif
@@ -0,0 +1,557 @@
+/*
+Hierarchical navigable small world index over the rows of an embedding matrix.
+
+Malkov and Yashunin, "Efficient and robust approximate nearest neighbor search using
+Hierarchical Navigable Small World graphs", https://arxiv.org/abs/1603.09320.
+
+The rows are stored as floats, row-major, and normalized, so the distance is one minus a dot
+product. Inner product is not a metric and a graph built on it finds the neighbors poorly, so it
+is reduced to cosine as in Bachrach et al., "Speeding up the Xbox recommender system using a
+Euclidean transformation for inner-product spaces": every row x gets the extra coordinate
+sqrt(max_norm^2 - |x|^2) and queries get 0, which keeps the order of the inner products. Vectors are inserted on several threads; every vector has a lock that
+guards its link lists and one global lock guards the entry point. A thread never holds two
+vector locks at once. Levels are drawn from a hash of the row number, so a single-threaded build
+is deterministic and does not touch R's random number generator.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <R.h>
+#include "hnsw.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "simd.h"
+#include "parallel.h"
+
+// Bumped whenever the file layout of HnswSave changes
+static const char hnsw_magic[8] = { 'R', 'L', 'H', 'N', 'S', 'W', '0', '1' };
+static const unsigned long long level_seed = 0x9E3779B97F4A7C15ULL;
+
+typedef std::pair<float, int> Candidate;   // distance to the query, vector id
+typedef std::priority_queue<Candidate> FarthestFirst;
+typedef std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > NearestFirst;
+
+// Vectors seen by the current search, marked with a tag instead of clearing the array every time
+struct Visited {
+	unsigned *marks;
+	unsigned tag;
+};
+
+struct BuildArg {
+	HnswIndex *index;
+};
+
+struct SearchArg {
+	const HnswIndex *index;
+	const double *queries;
+	long long num_queries;
+	int k, ef, *result_ids;
+	double *result_similarity;
+};
+
+static inline const float *Row(const HnswIndex *index, long long v)
+{
+	return index->data + v * index->row_dim;
+}
+
+static inline int *Links(const HnswIndex *index, long long v, int level)
+{
+	if (level == 0) return index->links0 + v * (1 + index->max_M0);
+	return index->links[v] + (long long)(level - 1) * (1 + index->M);
+}
+
+static inline float Distance(const HnswIndex *index, const float *a, const float *b)
+{
+	return 1 - SimdDotFloat(a, b, index->row_dim);
+}
+
+static void InitVisited(Visited *visited, long long n)
+{
+	visited->marks = (unsigned *)calloc(n, sizeof(unsigned));
+	visited->tag = 0;
+}
+
+static void NextVisited(Visited *visited, long long n)
+{
+	if (++visited->tag == 0)
+	{
+		memset(visited->marks, 0, n * sizeof(unsigned));
+		visited->tag = 1;
+	}
+}
+
+/* Copy the links of v at level into neighbors, under the lock of v while the index is built */
+static int CopyLinks(const HnswIndex *index, long long v, int level, int *neighbors, int locked)
+{
+	if (locked) pthread_mutex_lock(&index->node_locks[v]);
+	int *links = Links(index, v, level), count = links[0];
+	memcpy(neighbors, links + 1, count * sizeof(int));
+	if (locked) pthread_mutex_unlock(&index->node_locks[v]);
+	return count;
+}
+
+/* Walk from entry to the vector closest to query at level */
+static Candidate GreedyClosest(const HnswIndex *index, const float *query, Candidate entry, int level, int *neighbors, int locked)
+{
+	int changed = 1;
+	while (changed)
+	{
+		changed = 0;
+		int count = CopyLinks(index, entry.second, level, neighbors, locked);
+		for (int i = 0; i != count; i++)
+		{
+			float d = Distance(index, query, Row(index, neighbors[i]));
+			if (d < entry.first)
+			{
+				entry = Candidate(d, neighbors[i]);
+				changed = 1;
+			}
+		}
+	}
+	return entry;
+}
+
+/* The ef vectors closest to query at level reachable from entries, farthest on top */
+static FarthestFirst SearchLayer(const HnswIndex *index, const float *query, const std::vector<Candidate> &entries, int ef, int level, Visited *visited, int *neighbors, int locked)
+{
+	FarthestFirst results;
+	NearestFirst candidates;
+
+	NextVisited(visited, index->num_vectors);
+	for (size_t i = 0; i != entries.size(); i++)
+	{
+		visited->marks[entries[i].second] = visited->tag;
+		results.push(entries[i]);
+		candidates.push(entries[i]);
+	}
+	while ((long long)results.size() > ef) results.pop();
+
+	while (!candidates.empty())
+	{
+		Candidate c = candidates.top();
+		if (c.first > results.top().first) break;
+		candidates.pop();
+
+		int count = CopyLinks(index, c.second, level, neighbors, locked);
+		for (int i = 0; i != count; i++)
+		{
+			int e = neighbors[i];
+			if (visited->marks[e] == visited->tag) continue;
+			visited->marks[e] = visited->tag;
+
+			float d = Distance(index, query, Row(index, e));
+			if ((long long)results.size() < ef || d < results.top().first)
+			{
+				candidates.push(Candidate(d, e));
+				results.push(Candidate(d, e));
+				if ((long long)results.size() > ef) results.pop();
+			}
+		}
+	}
+	return results;
+}
+
+/* Keep at most M of candidates, sorted nearest first, that are closer to the query than to every kept one */
+static void SelectNeighbors(const HnswIndex *index, std::vector<Candidate> &candidates, int M)
+{
+	if ((int)candidates.size() <= M) return;
+	std::vector<Candidate> selected;
+	for (size_t i = 0; i != candidates.size() && (int)selected.size() < M; i++)
+	{
+		const float *row = Row(index, candidates[i].second);
+		int keep = 1;
+		for (size_t j = 0; j != selected.size(); j++)
+		{
+			if (Distance(index, row, Row(index, selected[j].second)) < candidates[i].first)
+			{
+				keep = 0;
+				break;
+			}
+		}
+		if (keep) selected.push_back(candidates[i]);
+	}
+	candidates.swap(selected);
+}
+
+static void SortedNearestFirst(FarthestFirst &heap, std::vector<Candidate> &sorted)
+{
+	sorted.resize(heap.size());
+	for (long long i = (long long)sorted.size() - 1; i >= 0; i--)
+	{
+		sorted[i] = heap.top();
+		heap.pop();
+	}
+}
+
+/* Link new_id into the links of v at level, pruning them with the heuristic when they are full */
+static void AddLink(HnswIndex *index, int v, int new_id, float distance, int level)
+{
+	int max_links = level == 0 ? index->max_M0 : index->M;
+
+	pthread_mutex_lock(&index->node_locks[v]);
+	int *links = Links(index, v, level);
+	if (links[0] < max_links) links[++links[0]] = new_id;
+	else
+	{
+		std::vector<Candidate> candidates;
+		candidates.push_back(Candidate(distance, new_id));
+		for (int i = 1; i <= links[0]; i++)
+			candidates.push_back(Candidate(Distance(index, Row(index, v), Row(index, links[i])), links[i]));
+		std::sort(candidates.begin(), candidates.end());
+		SelectNeighbors(index, candidates, max_links);
+		links[0] = (int)candidates.size();
+		for (int i = 0; i != links[0]; i++) links[i + 1] = candidates[i].second;
+	}
+	pthread_mutex_unlock(&index->node_locks[v]);
+}
+
+static void Insert(HnswIndex *index, long long v, Visited *visited, int *neighbors)
+{
+	int level = index->levels[v];
+	const float *query = Row(index, v);
+
+	// A vector that raises the top level keeps the global lock until it is the entry point
+	pthread_mutex_lock(&index->global_lock);
+	int max_level = index->max_level;
+	long long entry_point = index->entry_point;
+	if (level <= max_level) pthread_mutex_unlock(&index->global_lock);
+	if (entry_point == -1)
+	{
+		index->entry_point = v;
+		index->max_level = level;
+		pthread_mutex_unlock(&index->global_lock);
+		return;
+	}
+
+	Candidate entry(Distance(index, query, Row(index, entry_point)), (int)entry_point);
+	for (int lc = max_level; lc > level; lc--) entry = GreedyClosest(index, query, entry, lc, neighbors, 1);
+
+	std::vector<Candidate> entries(1, entry), selected;
+	for (int lc = std::min(level, max_level); lc >= 0; lc--)
+	{
+		FarthestFirst heap = SearchLayer(index, query, entries, index->ef_construction, lc, visited, neighbors, 1);
+		SortedNearestFirst(heap, entries);
+		selected = entries;
+		SelectNeighbors(index, selected, index->M);
+
+		pthread_mutex_lock(&index->node_locks[v]);
+		int *links = Links(index, v, lc);
+		links[0] = (int)selected.size();
+		for (int i = 0; i != links[0]; i++) links[i + 1] = selected[i].second;
+		pthread_mutex_unlock(&index->node_locks[v]);
+
+		for (size_t i = 0; i != selected.size(); i++) AddLink(index, selected[i].second, (int)v, selected[i].first, lc);
+	}
+
+	if (level > max_level)
+	{
+		index->entry_point = v;
+		index->max_level = level;
+		pthread_mutex_unlock(&index->global_lock);
+	}
+}
+
+static void BuildTask(long long begin, long long end, void *arg)
+{
+	HnswIndex *index = ((BuildArg *)arg)->index;
+	Visited visited;
+	std::vector<int> neighbors(index->max_M0 + 1);
+
+	InitVisited(&visited, index->num_vectors);
+	for (long long v = begin; v != end; v++) Insert(index, v, &visited, &neighbors[0]);
+	free(visited.marks);
+}
+
+/* Level of vector v, geometric with ratio 1 / M, drawn from a splitmix64 hash of v */
+static int RandomLevel(long long v, int M)
+{
+	unsigned long long z = (unsigned long long)v + level_seed;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z = z ^ (z >> 31);
+	double u = ((z >> 11) + 1) * (1.0 / 9007199254740992.0);
+	return (int)(-log(u) / log((double)M));
+}
+
+static void NormalizeRow(float *row, int dim)
+{
+	float len = SimdDotFloat(row, row, dim);
+	if (len <= 0) return;
+	len = sqrtf(len);
+	for (int c = 0; c != dim; c++) row[c] /= len;
+}
+
+static HnswIndex *AllocIndex(long long rows, int dim, int metric, int M, int ef_construction)
+{
+	HnswIndex *index = new HnswIndex();
+	index->dim = dim;
+	index->row_dim = metric == HNSW_INNER_PRODUCT ? dim + 1 : dim;
+	index->max_norm = 0;
+	index->metric = metric;
+	index->M = M;
+	index->max_M0 = 2 * M;
+	index->ef_construction = ef_construction;
+	index->max_level = -1;
+	index->num_vectors = rows;
+	index->entry_point = -1;
+	index->data = (float *)malloc(rows * index->row_dim * sizeof(float) + 1);
+	index->levels = (int *)calloc(rows + 1, sizeof(int));
+	index->links0 = (int *)calloc(rows * (1 + index->max_M0) + 1, sizeof(int));
+	index->links = (int **)calloc(rows + 1, sizeof(int *));
+	index->node_locks = (pthread_mutex_t *)malloc((rows + 1) * sizeof(pthread_mutex_t));
+	if (index->data == NULL || index->levels == NULL || index->links0 == NULL || index->links == NULL || index->node_locks == NULL)
+	{
+		free(index->data);
+		free(index->levels);
+		free(index->links0);
+		free(index->links);
+		free(index->node_locks);
+		delete index;
+		return NULL;
+	}
+	for (long long v = 0; v != rows; v++) pthread_mutex_init(&index->node_locks[v], NULL);
+	pthread_mutex_init(&index->global_lock, NULL);
+	return index;
+}
+
+/* Index the rows of a column-major rows x dim embedding; NULL when the index does not fit in memory */
+HnswIndex *HnswBuild(const double *embedding, long long rows, int dim, const char **names, int metric, int M, int ef_construction, int num_threads)
+{
+	TRACE_SCOPE("HnswBuild");
+	PerfCounters pc;
+	PerfReset();
+	PerfStart(&pc, "hnsw build");
+
+	HnswIndex *index = AllocIndex(rows, dim, metric, M, ef_construction);
+	if (index == NULL)
+	{
+		PerfStop(&pc);
+		Rprintf("Error: memory allocation failed\n");
+		return NULL;
+	}
+	std::vector<double> norms(rows, 0.0);
+	for (int c = 0; c != dim; c++) SimdSquareAdd(&norms[0], embedding + c * rows, rows);
+	for (long long v = 0; v != rows; v++) index->max_norm = std::max(index->max_norm, sqrt(norms[v]));
+	for (long long v = 0; v != rows; v++)
+	{
+		float *row = index->data + v * index->row_dim;
+		for (int c = 0; c != dim; c++) row[c] = (float)embedding[c * rows + v];
+		if (metric == HNSW_INNER_PRODUCT) row[dim] = (float)sqrt(std::max(0.0, index->max_norm * index->max_norm - norms[v]));
+		NormalizeRow(row, index->row_dim);
+
+		index->levels[v] = RandomLevel(v, M);
+		if (index->levels[v] > 0)
+		{
+			index->links[v] = (int *)calloc((long long)index->levels[v] * (1 + M), sizeof(int));
+			if (index->links[v] == NULL)
+			{
+				PerfStop(&pc);
+				Rprintf("Error: memory allocation failed\n");
+				HnswFree(index);
+				return NULL;
+			}
+		}
+		index->names.push_back(std::string(names[v]));
+	}
+
+	BuildArg arg;
+	arg.index = index;
+	ParallelFor(rows, 1, num_threads, BuildTask, &arg);
+	PerfStop(&pc);
+	PerfPrint();
+	return index;
+}
+
+static void SearchTask(long long begin, long long end, void *arg)
+{
+	SearchArg *s = (SearchArg *)arg;
+	const HnswIndex *index = s->index;
+	Visited visited;
+	std::vector<int> neighbors(index->max_M0 + 1);
+	std::vector<float> query(index->row_dim, 0.0f);
+	std::vector<Candidate> found;
+
+	InitVisited(&visited, index->num_vectors);
+	for (long long q = begin; q != end; q++)
+	{
+		for (int c = 0; c != index->dim; c++) query[c] = (float)s->queries[c * s->num_queries + q];
+		double scale = index->max_norm * sqrt(SimdDotFloat(&query[0], &query[0], index->dim));
+		NormalizeRow(&query[0], index->row_dim);
+
+		found.clear();
+		if (index->entry_point != -1)
+		{
+			Candidate entry(Distance(index, &query[0], Row(index, index->entry_point)), (int)index->entry_point);
+			for (int lc = index->max_level; lc > 0; lc--) entry = GreedyClosest(index, &query[0], entry, lc, &neighbors[0], 0);
+			FarthestFirst heap = SearchLayer(index, &query[0], std::vector<Candidate>(1, entry), std::max(s->ef, s->k), 0, &visited, &neighbors[0], 0);
+			SortedNearestFirst(heap, found);
+		}
+		for (int r = 0; r != s->k; r++)
+		{
+			long long out = r * s->num_queries + q;
+			if (r < (int)found.size())
+			{
+				s->result_ids[out] = found[r].second;
+				s->result_similarity[out] = index->metric == HNSW_COSINE ? 1 - found[r].first : (1 - found[r].first) * scale;
+			}
+			else
+			{
+				s->result_ids[out] = -1;
+				s->result_similarity[out] = NAN;
+			}
+		}
+	}
+	free(visited.marks);
+}
+
+/* The k approximate nearest rows of every row of a column-major num_queries x dim matrix, written
+   column-major into num_queries x k id and similarity matrices; id -1 where fewer rows were found */
+void HnswSearch(const HnswIndex *index, const double *queries, long long num_queries, int k, int ef, int num_threads, int *result_ids, double *result_similarity)
+{
+	TRACE_SCOPE("HnswSearch");
+	PerfReset();
+	SearchArg arg;
+	arg.index = index;
+	arg.queries = queries;
+	arg.num_queries = num_queries;
+	arg.k = k;
+	arg.ef = ef;
+	arg.result_ids = result_ids;
+	arg.result_similarity = result_similarity;
+
+	PerfCounters pc;
+	PerfStart(&pc, "hnsw search");
+	ParallelFor(num_queries, 1, num_threads, SearchTask, &arg);
+	PerfStop(&pc);
+	PerfPrint();
+}
+
+/* Write the index to file; 0 when the file cannot be written */
+int HnswSave(const HnswIndex *index, const char *file)
+{
+	FILE *fo = fopen(file, "wb");
+	if (fo == NULL) return 0;
+
+	int header[6] = { index->dim, index->metric, index->M, index->max_M0, index->ef_construction, index->max_level };
+	long long sizes[2] = { index->num_vectors, index->entry_point };
+	long long rows = index->num_vectors;
+	int ok = fwrite(hnsw_magic, sizeof(hnsw_magic), 1, fo) == 1 && fwrite(header, sizeof(header), 1, fo) == 1 &&
+	         fwrite(sizes, sizeof(sizes), 1, fo) == 1 && fwrite(&index->max_norm, sizeof(double), 1, fo) == 1 &&
+	         (long long)fwrite(index->data, sizeof(float), rows * index->row_dim, fo) == rows * index->row_dim &&
+	         (long long)fwrite(index->levels, sizeof(int), rows, fo) == rows &&
+	         (long long)fwrite(index->links0, sizeof(int), rows * (1 + index->max_M0), fo) == rows * (1 + index->max_M0);
+	for (long long v = 0; ok && v != rows; v++)
+	{
+		long long n = (long long)index->levels[v] * (1 + index->M);
+		if (n > 0) ok = (long long)fwrite(index->links[v], sizeof(int), n, fo) == n;
+	}
+	for (long long v = 0; ok && v != rows; v++)
+	{
+		long long length = (long long)index->names[v].size();
+		ok = fwrite(&length, sizeof(length), 1, fo) == 1 && (long long)fwrite(index->names[v].data(), 1, length, fo) == length;
+	}
+	if (fclose(fo) != 0) ok = 0;
+	return ok;
+}
+
+/* 1 when every link list of v has a valid count and only ids of indexed vectors that have links at
+   that level themselves; all levels have to be read already */
+static int ValidLinks(const HnswIndex *index, long long v)
+{
+	for (int level = 0; level <= index->levels[v]; level++)
+	{
+		int *links = Links(index, v, level);
+		if (links[0] < 0 || links[0] > (level == 0 ? index->max_M0 : index->M)) return 0;
+		for (int i = 1; i <= links[0]; i++)
+			if (links[i] < 0 || links[i] >= index->num_vectors || index->levels[links[i]] < level) return 0;
+	}
+	return 1;
+}
+
+/* Read an index written by HnswSave; NULL when the file is missing, truncated or not an index. The
+   file has no checksum, but the links are checked to only lead to levels the search can read. */
+HnswIndex *HnswLoad(const char *file)
+{
+	FILE *fi = fopen(file, "rb");
+	if (fi == NULL) return NULL;
+
+	char magic[sizeof(hnsw_magic)];
+	int header[6];
+	long long sizes[2];
+	double max_norm;
+	if (fread(magic, sizeof(magic), 1, fi) != 1 || memcmp(magic, hnsw_magic, sizeof(magic)) != 0 ||
+	    fread(header, sizeof(header), 1, fi) != 1 || fread(sizes, sizeof(sizes), 1, fi) != 1 ||
+	    fread(&max_norm, sizeof(max_norm), 1, fi) != 1 ||
+	    header[0] <= 0 || (header[1] != HNSW_COSINE && header[1] != HNSW_INNER_PRODUCT) || header[2] <= 1 || header[3] != 2 * header[2] || header[5] < -1 || sizes[0] < 0)
+	{
+		fclose(fi);
+		return NULL;
+	}
+
+	long long rows = sizes[0];
+	HnswIndex *index = AllocIndex(rows, header[0], header[1], header[2], header[4]);
+	if (index == NULL)
+	{
+		fclose(fi);
+		return NULL;
+	}
+	index->max_level = header[5];
+	index->entry_point = sizes[1];
+	index->max_norm = max_norm;
+	int ok = (long long)fread(index->data, sizeof(float), rows * index->row_dim, fi) == rows * index->row_dim &&
+	         (long long)fread(index->levels, sizeof(int), rows, fi) == rows &&
+	         (long long)fread(index->links0, sizeof(int), rows * (1 + index->max_M0), fi) == rows * (1 + index->max_M0);
+	for (long long v = 0; ok && v != rows; v++)
+	{
+		long long n = (long long)index->levels[v] * (1 + index->M);
+		if (index->levels[v] < 0 || index->levels[v] > index->max_level) ok = 0;
+		else if (n > 0)
+		{
+			index->links[v] = (int *)malloc(n * sizeof(int));
+			ok = index->links[v] != NULL && (long long)fread(index->links[v], sizeof(int), n, fi) == n;
+		}
+		if (ok) ok = ValidLinks(index, v);
+	}
+	for (long long v = 0; ok && v != rows; v++)
+	{
+		long long length;
+		ok = fread(&length, sizeof(length), 1, fi) == 1 && length >= 0;
+		if (!ok) break;
+		std::string name(length, '\0');
+		ok = length == 0 || (long long)fread(&name[0], 1, length, fi) == length;
+		index->names.push_back(name);
+	}
+	fclose(fi);
+	// The search starts at max_level from the entry point, which needs links up to there
+	if (ok) ok = index->entry_point == -1 ? rows == 0 && index->max_level == -1 :
+	             index->entry_point >= 0 && index->entry_point < rows && index->levels[index->entry_point] == index->max_level;
+	if (!ok)
+	{
+		HnswFree(index);
+		return NULL;
+	}
+	return index;
+}
+
+void HnswFree(HnswIndex *index)
+{
+	if (index == NULL) return;
+	for (long long v = 0; v != index->num_vectors; v++)
+	{
+		pthread_mutex_destroy(&index->node_locks[v]);
+		free(index->links[v]);
+	}
+	pthread_mutex_destroy(&index->global_lock);
+	free(index->links);
+	free(index->links0);
+	free(index->levels);
+	free(index->data);
+	free(index->node_locks);
+	delete index;
+}
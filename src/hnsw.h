@@ -0,0 +1,28 @@
+#include <vector>
+#include <string>
+#include <pthread.h>
+
+#ifndef HNSW_H
+#define HNSW_H
+
+enum HnswMetric { HNSW_COSINE = 0, HNSW_INNER_PRODUCT };
+
+// Hierarchical navigable small world graph over the rows of an embedding matrix
+struct HnswIndex {
+	int dim, row_dim, metric, M, max_M0, ef_construction, max_level;
+	long long num_vectors, entry_point;
+	double max_norm;                       // longest input row, scales inner products back
+	float *data;                           // num_vectors x row_dim, row-major, unit rows
+	int *levels;                           // top level of every vector
+	int *links0;                           // level 0 links of every vector: count, then up to max_M0 ids
+	int **links;                           // levels 1 to levels[v] of vector v: count, then up to M ids each
+	pthread_mutex_t *node_locks, global_lock;
+	std::vector<std::string> names;
+};
+
+HnswIndex *HnswBuild(const double *embedding, long long rows, int dim, const char **names, int metric, int M, int ef_construction, int num_threads);
+void HnswSearch(const HnswIndex *index, const double *queries, long long num_queries, int k, int ef, int num_threads, int *result_ids, double *result_similarity);
+int HnswSave(const HnswIndex *index, const char *file);
+HnswIndex *HnswLoad(const char *file);
+void HnswFree(HnswIndex *index);
+#endif
@@ -0,0 +1,94 @@
+/*
+Allocator for the large arrays of the trainers, backed by 2 MB pages where possible.
+
+Random rows of multi-GB embeddings and sampling tables miss the dTLB on almost every access
+with 4 KB pages. An allocation of at least one huge page is first taken from the explicit huge
+page pool (hugetlbfs, MAP_HUGETLB), which only succeeds when pages were reserved, then mapped
+at a 2 MB boundary and marked with madvise(MADV_HUGEPAGE) for transparent huge pages, and
+finally falls back to an ordinary aligned allocation. Mapped regions are remembered so that
+HugeFree can tell them from ordinary allocations.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <map>
+#include "huge_pages.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#define SMALL_ALIGNMENT 128
+
+const char *huge_page_kind_names[3] = { "none", "transparent", "explicit" };
+
+static std::map<void *, size_t> mapped_regions;
+static pthread_mutex_t mapped_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef __linux__
+static void *MapHuge(size_t bytes, int *kind)
+{
+	size_t size = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+	p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (p != MAP_FAILED) *kind = HUGE_PAGES_EXPLICIT;
+#endif
+	if (p == MAP_FAILED)
+	{
+		// Map one page more than needed and unmap the ends, so that the region starts on a 2 MB
+		// boundary and every page of it can be a huge page
+		char *raw = (char *)mmap(NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (raw == MAP_FAILED) return NULL;
+		char *aligned = (char *)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+		if (aligned != raw) munmap(raw, aligned - raw);
+		if (aligned + size != raw + size + HUGE_PAGE_SIZE) munmap(aligned + size, raw + size + HUGE_PAGE_SIZE - (aligned + size));
+		p = aligned;
+		*kind = HUGE_PAGES_NONE;
+#ifdef MADV_HUGEPAGE
+		if (madvise(p, size, MADV_HUGEPAGE) == 0) *kind = HUGE_PAGES_TRANSPARENT;
+#endif
+	}
+	pthread_mutex_lock(&mapped_mutex);
+	mapped_regions[p] = size;
+	pthread_mutex_unlock(&mapped_mutex);
+	return p;
+}
+#endif
+
+/* Allocate bytes aligned to at least 128 bytes, with huge pages if huge is set and the array is at
+   least one huge page; sets *kind to how it is backed. Returns NULL if out of memory. */
+void *HugeAlloc(size_t bytes, int huge, int *kind)
+{
+	int backed = HUGE_PAGES_NONE;
+	void *p = NULL;
+#ifdef __linux__
+	if (huge && bytes >= HUGE_PAGE_SIZE) p = MapHuge(bytes, &backed);
+#endif
+	if (p == NULL && posix_memalign(&p, SMALL_ALIGNMENT, bytes > 0 ? bytes : 1) != 0) p = NULL;
+	if (kind != NULL) *kind = backed;
+	return p;
+}
+
+void HugeFree(void *p)
+{
+	if (p == NULL) return;
+#ifdef __linux__
+	pthread_mutex_lock(&mapped_mutex);
+	std::map<void *, size_t>::iterator it = mapped_regions.find(p);
+	size_t size = 0;
+	if (it != mapped_regions.end())
+	{
+		size = it->second;
+		mapped_regions.erase(it);
+	}
+	pthread_mutex_unlock(&mapped_mutex);
+	if (size != 0)
+	{
+		munmap(p, size);
+		return;
+	}
+#endif
+	free(p);
+}
@@ -0,0 +1,15 @@
+#include <stddef.h>
+
+#ifndef HUGE_PAGES_H
+#define HUGE_PAGES_H
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// How the memory of an allocation is backed
+enum HugePageKind { HUGE_PAGES_NONE = 0, HUGE_PAGES_TRANSPARENT, HUGE_PAGES_EXPLICIT };
+
+extern const char *huge_page_kind_names[3];
+
+void *HugeAlloc(size_t bytes, int huge, int *kind = NULL);
+void HugeFree(void *p);
+#endif
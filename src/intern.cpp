@@ -0,0 +1,190 @@
+/*
+Sharded dictionary for interning vertex names on many threads at once.
+
+The names are spread over INTERN_SHARDS open addressing tables by the top bits of their hash, and
+every table has a lock of its own, so threads adding different names rarely wait for each other.
+Each entry remembers the smallest position its name was added at. Adding is the only phase that
+takes locks: InternerAssignIds sorts the entries by that position and numbers them in turn, after
+which InternerFind reads the tables without locking. As the smallest position of a name does not
+depend on which thread saw it first, the ids are those that interning the names in order gives.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <algorithm>
+#include "intern.h"
+
+#define INTERN_SHARDS 256               // power of two, well above the number of threads
+#define INTERN_SHARD_BITS 8
+#define INTERN_INITIAL_SLOTS 64
+
+struct InternEntry {
+	const char *name;                      // NULL if the slot is empty
+	unsigned long long hash;
+	long long first;                       // smallest position the name was added at
+	long long id;
+};
+
+struct InternShard {
+	pthread_mutex_t lock;
+	InternEntry *entries;
+	unsigned long long mask;
+	long long count;
+	char padding[64];                      // keeps the locks of neighbouring shards off one cache line
+};
+
+struct ShardedInterner {
+	InternShard shards[INTERN_SHARDS];
+	const char **names;                    // names in id order, once assigned
+	long long num_names;
+};
+
+/* FNV-1a hash of a name */
+static unsigned long long Hash(const char *key)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	while (*key)
+	{
+		hash ^= (unsigned char)(*key++);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static InternEntry *Probe(InternEntry *entries, unsigned long long mask, const char *name, unsigned long long hash)
+{
+	unsigned long long addr = hash & mask;
+	while (entries[addr].name != NULL && (entries[addr].hash != hash || strcmp(entries[addr].name, name)))
+		addr = (addr + 1) & mask;
+	return &entries[addr];
+}
+
+/* Double the table of a shard before it gets more than half full */
+static int GrowShard(InternShard *shard)
+{
+	unsigned long long size = (shard->mask + 1) * 2;
+	InternEntry *entries = (InternEntry *)calloc(size, sizeof(InternEntry));
+	if (entries == NULL) return 0;
+	for (unsigned long long k = 0; k <= shard->mask; k++)
+		if (shard->entries[k].name != NULL)
+			*Probe(entries, size - 1, shard->entries[k].name, shard->entries[k].hash) = shard->entries[k];
+	free(shard->entries);
+	shard->entries = entries;
+	shard->mask = size - 1;
+	return 1;
+}
+
+ShardedInterner *InternerCreate()
+{
+	ShardedInterner *interner = (ShardedInterner *)calloc(1, sizeof(ShardedInterner));
+	if (interner == NULL) return NULL;
+	for (int s = 0; s != INTERN_SHARDS; s++)
+	{
+		InternShard *shard = &interner->shards[s];
+		pthread_mutex_init(&shard->lock, NULL);
+		shard->entries = (InternEntry *)calloc(INTERN_INITIAL_SLOTS, sizeof(InternEntry));
+		shard->mask = INTERN_INITIAL_SLOTS - 1;
+		if (shard->entries == NULL)
+		{
+			InternerFree(interner);
+			return NULL;
+		}
+	}
+	return interner;
+}
+
+/* Add name, seen at position, which must outlive the interner; safe to call from any number of
+   threads. Returns 0 if out of memory. */
+int InternerAdd(ShardedInterner *interner, const char *name, long long position)
+{
+	unsigned long long hash = Hash(name);
+	InternShard *shard = &interner->shards[hash >> (64 - INTERN_SHARD_BITS)];
+	int ok = 1;
+	pthread_mutex_lock(&shard->lock);
+	InternEntry *entry = Probe(shard->entries, shard->mask, name, hash);
+	if (entry->name != NULL)
+	{
+		if (position < entry->first) entry->first = position;
+	}
+	else if (2 * (unsigned long long)(shard->count + 1) > shard->mask + 1 && !GrowShard(shard)) ok = 0;
+	else
+	{
+		entry = Probe(shard->entries, shard->mask, name, hash);   // the table may have grown
+		entry->name = name;
+		entry->hash = hash;
+		entry->first = position;
+		shard->count++;
+	}
+	pthread_mutex_unlock(&shard->lock);
+	return ok;
+}
+
+static bool FirstSeen(const InternEntry *a, const InternEntry *b)
+{
+	return a->first < b->first;
+}
+
+/* Number the names in the order of their first positions; returns how many there are, or -1 if
+   out of memory */
+long long InternerAssignIds(ShardedInterner *interner)
+{
+	long long num_names = 0;
+	for (int s = 0; s != INTERN_SHARDS; s++) num_names += interner->shards[s].count;
+	InternEntry **order = (InternEntry **)malloc(num_names * sizeof(InternEntry *) + 1);
+	free(interner->names);
+	interner->names = (const char **)malloc(num_names * sizeof(const char *) + 1);
+	if (order == NULL || interner->names == NULL)
+	{
+		free(order);
+		return -1;
+	}
+	long long n = 0;
+	for (int s = 0; s != INTERN_SHARDS; s++)
+		for (unsigned long long k = 0; k <= interner->shards[s].mask; k++)
+			if (interner->shards[s].entries[k].name != NULL) order[n++] = &interner->shards[s].entries[k];
+	std::sort(order, order + num_names, FirstSeen);
+	for (long long id = 0; id != num_names; id++)
+	{
+		order[id]->id = id;
+		interner->names[id] = order[id]->name;
+	}
+	free(order);
+	interner->num_names = num_names;
+	return num_names;
+}
+
+/* Id of name, or -1 if it was never added; only valid after InternerAssignIds, and safe to call
+   from any number of threads */
+long long InternerFind(const ShardedInterner *interner, const char *name)
+{
+	unsigned long long hash = Hash(name);
+	const InternShard *shard = &interner->shards[hash >> (64 - INTERN_SHARD_BITS)];
+	const InternEntry *entry = Probe(shard->entries, shard->mask, name, hash);
+	return entry->name == NULL ? -1 : entry->id;
+}
+
+const char *InternerName(const ShardedInterner *interner, long long id)
+{
+	return interner->names[id];
+}
+
+void InternerFree(ShardedInterner *interner)
+{
+	if (interner == NULL) return;
+	for (int s = 0; s != INTERN_SHARDS; s++)
+	{
+		pthread_mutex_destroy(&interner->shards[s].lock);
+		free(interner->shards[s].entries);
+	}
+	free(interner->names);
+	free(interner);
+}
+
+/* Bytes an interner of num_names names needs at most: tables of at most four slots per name, as
+   they double when half full, and the sort and name arrays */
+long long InternerBytes(long long num_names)
+{
+	long long slots = 4 * num_names + INTERN_SHARDS * INTERN_INITIAL_SLOTS;
+	return (long long)sizeof(ShardedInterner) + slots * (long long)sizeof(InternEntry) + num_names * (long long)(sizeof(InternEntry *) + sizeof(const char *));
+}
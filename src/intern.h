@@ -0,0 +1,18 @@
+#include <stddef.h>
+
+#ifndef INTERN_H
+#define INTERN_H
+
+struct ShardedInterner;
+
+// Dictionary of names that many threads add to at once, each name with the position it appears
+// at. Once all names are added, InternerAssignIds numbers them densely by their first position,
+// the numbering of adding them one by one in order, whatever the threads did.
+ShardedInterner *InternerCreate();
+int InternerAdd(ShardedInterner *interner, const char *name, long long position);
+long long InternerAssignIds(ShardedInterner *interner);
+long long InternerFind(const ShardedInterner *interner, const char *name);
+const char *InternerName(const ShardedInterner *interner, long long id);
+void InternerFree(ShardedInterner *interner);
+long long InternerBytes(long long num_names);
+#endif
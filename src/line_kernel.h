@@ -0,0 +1,83 @@
+#include <math.h>
+
+#ifndef LINE_KERNEL_H
+#define LINE_KERNEL_H
+
+#define SIGMOID_BOUND 6
+#define ROW_ALIGNMENT 64                // bytes; embedding rows start on a cache line
+
+static const int sigmoid_table_size = 1000;
+
+typedef float real;                    // Precision of float numbers
+
+/* Floats from the start of one embedding row to the next: dim rounded up to whole cache lines, so
+   that rows do not straddle lines and two threads updating neighboring rows share no line */
+inline long long PaddedRowStride(int dim)
+{
+	long long line = ROW_ALIGNMENT / sizeof(real);
+	return (dim + line - 1) / line * line;
+}
+
+/* Fastly compute sigmoid function */
+inline void InitSigmoidTable(real *sigmoid_table)
+{
+	real x;
+	for (int k = 0; k != sigmoid_table_size; k++)
+	{
+		x = 2 * SIGMOID_BOUND * k / sigmoid_table_size - SIGMOID_BOUND;
+		sigmoid_table[k] = 1 / (1 + exp(-x));
+	}
+}
+
+inline real FastSigmoid(const real *sigmoid_table, real x)
+{
+	if (x > SIGMOID_BOUND) return 1;
+	else if (x < -SIGMOID_BOUND) return 0;
+	int k = (x + SIGMOID_BOUND) * sigmoid_table_size / SIGMOID_BOUND / 2;
+	return sigmoid_table[k];
+}
+
+/* Update embeddings; shared by the trainer and the kernel benchmark */
+inline void Update(real *vec_u, real *vec_v, real *vec_error, int label, int dim, real rho, const real *sigmoid_table)
+{
+	real x = 0, g;
+	for (int c = 0; c != dim; c++) x += vec_u[c] * vec_v[c];
+	g = (label - FastSigmoid(sigmoid_table, x)) * rho;
+	for (int c = 0; c != dim; c++) vec_error[c] += g * vec_v[c];
+	for (int c = 0; c != dim; c++) vec_v[c] += g * vec_u[c];
+}
+
+/* Update with vec_v frozen: only the error of vec_u is accumulated; used to fold in new vertices */
+inline void UpdateSource(const real *vec_u, const real *vec_v, real *vec_error, int label, int dim, real rho, const real *sigmoid_table)
+{
+	real x = 0, g;
+	for (int c = 0; c != dim; c++) x += vec_u[c] * vec_v[c];
+	g = (label - FastSigmoid(sigmoid_table, x)) * rho;
+	for (int c = 0; c != dim; c++) vec_error[c] += g * vec_v[c];
+}
+
+/* Update with the change of vec_v accumulated into delta_v instead of vec_v; used for hub vertices,
+   whose rows are written back from a thread-local buffer now and then. The row is read as vec_v plus
+   the pending delta_v, so the thread sees its own updates before they are written back. */
+inline void UpdateBuffered(const real *vec_u, const real *vec_v, real *vec_error, real *delta_v, int label, int dim, real rho,
+                           const real *sigmoid_table)
+{
+	real x = 0, g;
+	for (int c = 0; c != dim; c++) x += vec_u[c] * (vec_v[c] + delta_v[c]);
+	g = (label - FastSigmoid(sigmoid_table, x)) * rho;
+	for (int c = 0; c != dim; c++) vec_error[c] += g * (vec_v[c] + delta_v[c]);
+	for (int c = 0; c != dim; c++) delta_v[c] += g * vec_u[c];
+}
+
+/* Floating point operations and bytes of embedding traffic of one training sample */
+inline double UpdateSampleFlops(int dim, int num_negative)
+{
+	return (double)(num_negative + 1) * (6.0 * dim + 3) + dim;
+}
+
+inline double UpdateSampleBytes(int dim, int num_negative)
+{
+	return (double)(2 * (num_negative + 1) + 2) * dim * sizeof(real);
+}
+
+#endif
@@ -20,17 +20,27 @@ Publication: Jian Tang, Meng Qu, Mingzhe Wang, Ming Zhang, Jun Yan, Qiaozhu Mei.
 #include <gsl/gsl_rng.h>
 #include <vector> 
 #include <string> 
+#include <limits>
+#include <algorithm>
+#include <atomic>
 #include <R.h>
+#include "line_kernel.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "memory_planner.h"
+#include "sampling.h"
+#include "huge_pages.h"
+#include "arena.h"
+#include "compressed_graph.h"
+#include "edge_file.h"
+#include "arrow_data.h"
+#include "intern.h"
+#include "parallel.h"
 
 #define MAX_STRING 100
-#define SIGMOID_BOUND 6
-#define NEG_SAMPLING_POWER 0.75
+#define HUB_FLUSH_SAMPLES 1024    // samples between write-backs of the hub buffers of a thread
 
-static const int hash_table_size = 30000000;
-static const int neg_table_size = 1e8;
-static const int sigmoid_table_size = 1000;
-
-typedef float real;                    // Precision of float numbers
+static const long long trace_chunk_samples = 1000000;
 
 struct ClassVertex {
 	double degree;
@@ -39,30 +49,60 @@ struct ClassVertex {
 
 static char network_file[MAX_STRING], embedding_file[MAX_STRING];
 static struct ClassVertex *vertex;
+static Arena vertex_names = ARENA_INIT;   // owns the names of all vertices of a run
 static int is_binary = 0, num_threads = 1, order = 2, dim = 100, num_negative = 5;
-static int *vertex_hash_table, *neg_table;
-static int max_num_vertices = 1000, num_vertices = 0;
+static long long row_stride = 112;     // floats between embedding rows, dim padded to cache lines
+static long long max_num_vertices = initial_vertex_capacity, num_vertices = 0;
 static long long total_samples = 1, current_sample_count = 0, num_edges = 0;
+static long long hash_table_size = default_hash_table_size, neg_table_size = default_neg_table_size, memory_budget = 0;
+static long long hub_vertices = 0;
+static int huge_pages = 1;              // back the embeddings and sampling tables with 2 MB pages
 static real init_rho = 0.025, rho;
 static real *emb_vertex, *emb_context, *sigmoid_table;
 
-static int *edge_source_id, *edge_target_id;
 static double *edge_weight;
-static int malloc_exit = 0;
+static std::vector< std::vector<double> > *output_context_vectors = NULL;   // context rows of order 2, when asked for
+static int malloc_exit = 0, index_overflow = 0;
+static long long vertex_id_limit = std::numeric_limits<int>::max();   // largest 32-bit vertex id, lowered by tests
+static int read_threads = 0;            // threads reading a data frame, 0 for num_threads; set by tests
+
+// The hub_vertices vertices of highest degree: hub_index maps a vertex to its hub slot or -1, and
+// hub_vertex maps a slot back to its vertex. Their updates are buffered per thread.
+static int *hub_index;
+static long long *hub_vertex;
+
+struct HubBuffer {
+	real *delta;                           // slot s < hub_vertices is a vertex row, the rest context rows
+	char *dirty;
+	int *touched;
+	int num_touched;
+};
+
+// Arrays indexed by or holding vertex ids (vid_t) and edge ids (eid_t). Graphs with fewer than
+// 2^31 vertices and edges use 32-bit ids, which halves these arrays; larger graphs use 64-bit ids.
+template <typename vid_t, typename eid_t>
+struct LineIndex {
+	static vid_t *vertex_hash_table, *edge_source_id, *edge_target_id, *neg_table;
+	static eid_t *alias;                   // Parameters for edge sampling
+};
+template <typename vid_t, typename eid_t> vid_t *LineIndex<vid_t, eid_t>::vertex_hash_table = NULL;
+template <typename vid_t, typename eid_t> vid_t *LineIndex<vid_t, eid_t>::edge_source_id = NULL;
+template <typename vid_t, typename eid_t> vid_t *LineIndex<vid_t, eid_t>::edge_target_id = NULL;
+template <typename vid_t, typename eid_t> vid_t *LineIndex<vid_t, eid_t>::neg_table = NULL;
+template <typename vid_t, typename eid_t> eid_t *LineIndex<vid_t, eid_t>::alias = NULL;
 
-// Parameters for edge sampling
-static long long *alias;
 static double *prob;
+static int alias_borrowed = 0;          // alias and prob belong to the input graph
 
 static const gsl_rng_type * gsl_T;
 static gsl_rng * gsl_r;
 
 
 /* Build a hash table, mapping each vertex name to a unique vertex id */
-static unsigned int Hash(char *key)
+static long long Hash(const char *key)
 {
-	unsigned int seed = 131;
-	unsigned int hash = 0;
+	unsigned long long seed = 131;
+	unsigned long long hash = 0;
 	while (*key)
 	{
 		hash = hash * seed + (*key++);
@@ -70,22 +110,29 @@ static unsigned int Hash(char *key)
 	return hash % hash_table_size;
 }
 
+template <typename vid_t, typename eid_t>
 static void InitHashTable()
 {
-	vertex_hash_table = (int *)malloc(hash_table_size * sizeof(int));
-	for (int k = 0; k != hash_table_size; k++) vertex_hash_table[k] = -1;
+	vid_t *&vertex_hash_table = LineIndex<vid_t, eid_t>::vertex_hash_table;
+	vertex_hash_table = (vid_t *)malloc(hash_table_size * sizeof(vid_t));
+	if (vertex_hash_table == NULL) return;
+	for (long long k = 0; k != hash_table_size; k++) vertex_hash_table[k] = -1;
 }
 
-static void InsertHashTable(char *key, int value)
+template <typename vid_t, typename eid_t>
+static void InsertHashTable(const char *key, long long value)
 {
-	int addr = Hash(key);
+	vid_t *vertex_hash_table = LineIndex<vid_t, eid_t>::vertex_hash_table;
+	long long addr = Hash(key);
 	while (vertex_hash_table[addr] != -1) addr = (addr + 1) % hash_table_size;
-	vertex_hash_table[addr] = value;
+	vertex_hash_table[addr] = (vid_t)value;
 }
 
-static int SearchHashTable(char *key)
+template <typename vid_t, typename eid_t>
+static long long SearchHashTable(const char *key)
 {
-	int addr = Hash(key);
+	vid_t *vertex_hash_table = LineIndex<vid_t, eid_t>::vertex_hash_table;
+	long long addr = Hash(key);
 	while (1)
 	{
 		if (vertex_hash_table[addr] == -1) return -1;
@@ -95,166 +142,208 @@ static int SearchHashTable(char *key)
 	return -1;
 }
 
-/* Add a vertex to the vertex set */
-static int AddVertex(char *name)
+/* Double the hash table once it is half full, so that probing stays short and never runs out of slots */
+template <typename vid_t, typename eid_t>
+static void GrowHashTable()
+{
+	free(LineIndex<vid_t, eid_t>::vertex_hash_table);
+	hash_table_size *= 2;
+	InitHashTable<vid_t, eid_t>();
+	for (long long k = 0; k != num_vertices; k++) InsertHashTable<vid_t, eid_t>(vertex[k].name, k);
+}
+
+/* Largest vertex id vid_t can hold */
+template <typename vid_t>
+static long long MaxVertexId()
+{
+	return sizeof(vid_t) == sizeof(int) ? vertex_id_limit : (long long)std::numeric_limits<vid_t>::max();
+}
+
+/* Add a vertex to the vertex set, or flag an overflow if vid_t cannot hold its id. The name is
+   copied whole into the name arena, and the vertex array doubles when full, so adding V vertices
+   costs O(V) instead of a malloc per name and a realloc every 1000 vertices. */
+template <typename vid_t, typename eid_t>
+static long long AddVertex(const char *name)
 {
-	int length = strlen(name) + 1;
-	if (length > MAX_STRING) length = MAX_STRING;
-	vertex[num_vertices].name = (char *)calloc(length, sizeof(char));
-	strncpy(vertex[num_vertices].name, name, length-1);
+	if (num_vertices == MaxVertexId<vid_t>())
+	{
+		index_overflow = 1;
+		return -1;
+	}
+	vertex[num_vertices].name = ArenaStrdup(&vertex_names, name);
+	if (vertex[num_vertices].name == NULL)
+	{
+		Rprintf("Error: memory allocation failed!\n");
+		malloc_exit = 1;
+		return -1;
+	}
 	vertex[num_vertices].degree = 0;
 	num_vertices++;
 	if (num_vertices + 2 >= max_num_vertices)
 	{
-		max_num_vertices += 1000;
-		vertex = (struct ClassVertex *)realloc(vertex, max_num_vertices * sizeof(struct ClassVertex));
+		struct ClassVertex *grown = (struct ClassVertex *)realloc(vertex, VERTEX_GROWTH * max_num_vertices * sizeof(struct ClassVertex));
+		if (grown == NULL)
+		{
+			Rprintf("Error: memory allocation failed!\n");
+			malloc_exit = 1;
+			return -1;
+		}
+		vertex = grown;
+		max_num_vertices *= VERTEX_GROWTH;
 	}
-	InsertHashTable(name, num_vertices - 1);
+	InsertHashTable<vid_t, eid_t>(name, num_vertices - 1);
+	if (num_vertices * 2 > hash_table_size) GrowHashTable<vid_t, eid_t>();
 	return num_vertices - 1;
 }
 
-/* The alias sampling algorithm, which is used to sample an edge in O(1) time. */
-static void InitAliasTable()
+/* Build the alias table of the edge weights, used to sample an edge in O(1) time, or borrow the one
+   that comes with graph */
+template <typename vid_t, typename eid_t>
+static void InitAliasTable(const CompressedGraph *graph)
 {
-	alias = (long long *)malloc(num_edges*sizeof(long long));
-	prob = (double *)malloc(num_edges*sizeof(double));
-	if (alias == NULL || prob == NULL)
-	{
-		Rprintf("Error: memory allocation failed!\n");
-        malloc_exit = 1;
-        return;
-    }
-
-	double *norm_prob = (double*)malloc(num_edges*sizeof(double));
-	long long *large_block = (long long*)malloc(num_edges*sizeof(long long));
-	long long *small_block = (long long*)malloc(num_edges*sizeof(long long));
-	if (norm_prob == NULL || large_block == NULL || small_block == NULL)
+	eid_t *&alias = LineIndex<vid_t, eid_t>::alias;
+	if (graph != NULL && graph->alias != NULL && sizeof(eid_t) == (GraphAliasIsInt(num_edges) ? sizeof(int) : sizeof(long long)))
 	{
-		Rprintf("Error: memory allocation failed!\n");
-	    malloc_exit = 1;
-        return;
-    }
-
-	double sum = 0;
-	long long cur_small_block, cur_large_block;
-	long long num_small_block = 0, num_large_block = 0;
-
-	for (long long k = 0; k != num_edges; k++) sum += edge_weight[k];
-	for (long long k = 0; k != num_edges; k++) norm_prob[k] = edge_weight[k] * num_edges / sum;
-
-	for (long long k = num_edges - 1; k >= 0; k--)
-	{
-		if (norm_prob[k]<1)
-			small_block[num_small_block++] = k;
-		else
-			large_block[num_large_block++] = k;
+		alias = (eid_t *)graph->alias;
+		prob = (double *)graph->prob;
+		alias_borrowed = 1;
+		return;
 	}
-
-	while (num_small_block && num_large_block)
+	alias = (eid_t *)HugeAlloc(num_edges*sizeof(eid_t), huge_pages);
+	prob = (double *)HugeAlloc(num_edges*sizeof(double), huge_pages);
+	if (alias == NULL || prob == NULL || !FillAliasTable(edge_weight, num_edges, alias, prob))
 	{
-		cur_small_block = small_block[--num_small_block];
-		cur_large_block = large_block[--num_large_block];
-		prob[cur_small_block] = norm_prob[cur_small_block];
-		alias[cur_small_block] = cur_large_block;
-		norm_prob[cur_large_block] = norm_prob[cur_large_block] + norm_prob[cur_small_block] - 1;
-		if (norm_prob[cur_large_block] < 1)
-			small_block[num_small_block++] = cur_large_block;
-		else
-			large_block[num_large_block++] = cur_large_block;
+		Rprintf("Error: memory allocation failed!\n");
+		malloc_exit = 1;
+		return;
 	}
-
-	while (num_large_block) prob[large_block[--num_large_block]] = 1;
-	while (num_small_block) prob[small_block[--num_small_block]] = 1;
-
-	free(norm_prob);
-	free(small_block);
-	free(large_block);
 }
 
+template <typename vid_t, typename eid_t>
 static long long SampleAnEdge(double rand_value1, double rand_value2)
 {
-	long long k = (long long)num_edges * rand_value1;
-	return rand_value2 < prob[k] ? k : alias[k];
+	return SampleAlias(prob, LineIndex<vid_t, eid_t>::alias, num_edges, rand_value1, rand_value2);
 }
 
-/* Initialize the vertex embedding and the context embedding */
+/* Initialize the vertex embedding and the context embedding, which only the second order uses */
 static void InitVector()
 {
 	long long a, b;
 
-	a = posix_memalign((void **)&emb_vertex, 128, (long long)num_vertices * dim * sizeof(real));
+	emb_vertex = (real *)HugeAlloc(num_vertices * row_stride * sizeof(real), huge_pages);
 	if (emb_vertex == NULL) { malloc_exit = 1; Rprintf("Error: memory allocation failed\n"); return; }
 	for (b = 0; b < dim; b++) for (a = 0; a < num_vertices; a++)
-		emb_vertex[a * dim + b] = (unif_rand() - 0.5) / dim;
+		emb_vertex[a * row_stride + b] = (unif_rand() - 0.5) / dim;
 
-	a = posix_memalign((void **)&emb_context, 128, (long long)num_vertices * dim * sizeof(real));
+	if (order != 2) return;
+	emb_context = (real *)HugeAlloc(num_vertices * row_stride * sizeof(real), huge_pages);
 	if (emb_context == NULL) { malloc_exit = 1; Rprintf("Error: memory allocation failed\n"); return; }
 	for (b = 0; b < dim; b++) for (a = 0; a < num_vertices; a++)
-		emb_context[a * dim + b] = 0;
+		emb_context[a * row_stride + b] = 0;
 }
 
 /* Sample negative vertex samples according to vertex degrees */
+static double VertexDegree(long long k)
+{
+	return vertex[k].degree;
+}
+
+template <typename vid_t, typename eid_t>
 static void InitNegTable()
 {
-	double sum = 0, cur_sum = 0, por = 0;
-	int vid = 0;
-	neg_table = (int *)malloc(neg_table_size * sizeof(int));
-	for (int k = 0; k != num_vertices; k++) sum += pow(vertex[k].degree, NEG_SAMPLING_POWER);
-	for (int k = 0; k != neg_table_size; k++)
-	{
-		if ((double)(k + 1) / neg_table_size > por)
-		{
-			cur_sum += pow(vertex[vid].degree, NEG_SAMPLING_POWER);
-			por = cur_sum / sum;
-			vid++;
-		}
-		neg_table[k] = vid - 1;
-	}
+	vid_t *&neg_table = LineIndex<vid_t, eid_t>::neg_table;
+	neg_table = (vid_t *)HugeAlloc(neg_table_size * sizeof(vid_t), huge_pages);
+	if (neg_table == NULL) { malloc_exit = 1; Rprintf("Error: memory allocation failed\n"); return; }
+	FillNegTable(neg_table, neg_table_size, num_vertices, VertexDegree);
 }
 
-/* Fastly compute sigmoid function */
-static void InitSigmoidTable()
+/* Pick the hub_vertices vertices of highest degree, ties broken by the lower id */
+static int HubOrder(long long a, long long b)
 {
-	real x;
-	sigmoid_table = (real *)malloc((sigmoid_table_size + 1) * sizeof(real));
-	for (int k = 0; k != sigmoid_table_size; k++)
+	return vertex[a].degree > vertex[b].degree || (vertex[a].degree == vertex[b].degree && a < b);
+}
+
+static void InitHubTable()
+{
+	if (hub_vertices > num_vertices) hub_vertices = num_vertices;
+	if (hub_vertices <= 0) return;
+	hub_index = (int *)malloc(num_vertices * sizeof(int));
+	hub_vertex = (long long *)malloc(hub_vertices * sizeof(long long));
+	if (hub_index == NULL || hub_vertex == NULL) { malloc_exit = 1; Rprintf("Error: memory allocation failed\n"); return; }
+	std::vector<long long> order_by_degree(num_vertices);
+	for (long long k = 0; k != num_vertices; k++) order_by_degree[k] = k;
+	std::partial_sort(order_by_degree.begin(), order_by_degree.begin() + hub_vertices, order_by_degree.end(), HubOrder);
+	for (long long k = 0; k != num_vertices; k++) hub_index[k] = -1;
+	for (long long s = 0; s != hub_vertices; s++)
 	{
-		x = 2 * SIGMOID_BOUND * k / sigmoid_table_size - SIGMOID_BOUND;
-		sigmoid_table[k] = 1 / (1 + exp(-x));
+		hub_vertex[s] = order_by_degree[s];
+		hub_index[order_by_degree[s]] = (int)s;
 	}
 }
 
-static real FastSigmoid(real x)
+/* The delta row of a hub slot, marked as touched on first use */
+static inline real *HubRow(HubBuffer &buffer, int slot)
 {
-	if (x > SIGMOID_BOUND) return 1;
-	else if (x < -SIGMOID_BOUND) return 0;
-	int k = (x + SIGMOID_BOUND) * sigmoid_table_size / SIGMOID_BOUND / 2;
-	return sigmoid_table[k];
+	if (!buffer.dirty[slot])
+	{
+		buffer.dirty[slot] = 1;
+		buffer.touched[buffer.num_touched++] = slot;
+	}
+	return buffer.delta + (long long)slot * dim;
 }
 
-/* Fastly generate a random integer */
-static int Rand(unsigned long long &seed)
+/* Add the touched delta rows of a thread to the shared rows and clear them */
+static void FlushHubBuffer(HubBuffer &buffer)
 {
-	seed = seed * 25214903917 + 11;
-	return (seed >> 16) % neg_table_size;
+	for (int t = 0; t != buffer.num_touched; t++)
+	{
+		int slot = buffer.touched[t];
+		real *delta = buffer.delta + (long long)slot * dim;
+		real *row = slot < hub_vertices ? &emb_vertex[hub_vertex[slot] * row_stride] : &emb_context[hub_vertex[slot - hub_vertices] * row_stride];
+		for (int c = 0; c != dim; c++)
+		{
+			row[c] += delta[c];
+			delta[c] = 0;
+		}
+		buffer.dirty[slot] = 0;
+	}
+	buffer.num_touched = 0;
 }
 
-/* Update embeddings */
-static void Update(real *vec_u, real *vec_v, real *vec_error, int label)
+/* Fastly generate a random integer */
+static long long Rand(unsigned long long &seed)
 {
-	real x = 0, g;
-	for (int c = 0; c != dim; c++) x += vec_u[c] * vec_v[c];
-	g = (label - FastSigmoid(x)) * rho;
-	for (int c = 0; c != dim; c++) vec_error[c] += g * vec_v[c];
-	for (int c = 0; c != dim; c++) vec_v[c] += g * vec_u[c];
+	return FastRand(seed, neg_table_size);
 }
 
+template <typename vid_t, typename eid_t>
 static void *TrainLINEThread(void *id)
 {
+	typedef LineIndex<vid_t, eid_t> Index;
 	long long u, v, lu, lv, target, label;
 	long long count = 0, last_count = 0, curedge;
 	unsigned long long seed = (long long)id;
-	real *vec_error = (real *)calloc(dim, sizeof(real));
+	real *vec_error = (real *)calloc(dim, sizeof(real)), *hub_source = NULL;
+	HubBuffer hub = { NULL, NULL, NULL, 0 };
+	if (hub_index != NULL)
+	{
+		long long slots = hub_vertices * (order == 2 ? 2 : 1);
+		hub.delta = (real *)calloc(slots * dim, sizeof(real));
+		hub.dirty = (char *)calloc(slots, sizeof(char));
+		hub.touched = (int *)malloc(slots * sizeof(int));
+		hub_source = (real *)malloc(dim * sizeof(real));
+		// Without the buffers this thread updates the hub rows in place, like every other row
+		if (hub.delta == NULL || hub.dirty == NULL || hub.touched == NULL || hub_source == NULL)
+		{
+			free(hub.delta); hub.delta = NULL;
+			free(hub.dirty); hub.dirty = NULL;
+			free(hub.touched); hub.touched = NULL;
+		}
+	}
+	PerfCounters pc;
+	PerfStart(&pc, "line train thread", (int)(long long)id);
+	TraceThreadName("line train thread");
+	double chunk_start = TraceEnabled() ? TraceNow() : -1;
 
 	while (1)
 	{
@@ -271,12 +360,20 @@ static void *TrainLINEThread(void *id)
 			if (rho < init_rho * 0.0001) rho = init_rho * 0.0001;
 		}
 
-		curedge = SampleAnEdge(gsl_rng_uniform(gsl_r), gsl_rng_uniform(gsl_r));
-		u = edge_source_id[curedge];
-		v = edge_target_id[curedge];
+		curedge = SampleAnEdge<vid_t, eid_t>(gsl_rng_uniform(gsl_r), gsl_rng_uniform(gsl_r));
+		u = Index::edge_source_id[curedge];
+		v = Index::edge_target_id[curedge];
 
-		lu = u * dim;
+		lu = u * row_stride;
 		for (int c = 0; c != dim; c++) vec_error[c] = 0;
+		// A hub source is read with the updates of this thread that are not written back yet
+		real *vec_u = &emb_vertex[lu];
+		if (hub.delta != NULL && hub_index[u] >= 0)
+		{
+			const real *delta = hub.delta + (long long)hub_index[u] * dim;
+			for (int c = 0; c != dim; c++) hub_source[c] = vec_u[c] + delta[c];
+			vec_u = hub_source;
+		}
 
 		// NEGATIVE SAMPLING
 		for (int d = 0; d != num_negative + 1; d++)
@@ -288,33 +385,54 @@ static void *TrainLINEThread(void *id)
 			}
 			else
 			{
-				target = neg_table[Rand(seed)];
+				target = Index::neg_table[Rand(seed)];
 				label = 0;
 			}
-			lv = target * dim;
-			if (order == 1) Update(&emb_vertex[lu], &emb_vertex[lv], vec_error, label);
-			if (order == 2) Update(&emb_vertex[lu], &emb_context[lv], vec_error, label);
+			lv = target * row_stride;
+			if (hub.delta != NULL && hub_index[target] >= 0)
+			{
+				int slot = order == 1 ? hub_index[target] : hub_vertices + hub_index[target];
+				real *vec_v = order == 1 ? &emb_vertex[lv] : &emb_context[lv];
+				UpdateBuffered(vec_u, vec_v, vec_error, HubRow(hub, slot), label, dim, rho, sigmoid_table);
+				continue;
+			}
+			if (order == 1) Update(vec_u, &emb_vertex[lv], vec_error, label, dim, rho, sigmoid_table);
+			if (order == 2) Update(vec_u, &emb_context[lv], vec_error, label, dim, rho, sigmoid_table);
 		}
-		for (int c = 0; c != dim; c++) emb_vertex[c + lu] += vec_error[c];
+		real *row_u = hub.delta != NULL && hub_index[u] >= 0 ? HubRow(hub, hub_index[u]) : &emb_vertex[lu];
+		for (int c = 0; c != dim; c++) row_u[c] += vec_error[c];
 
 		count++;
+		if (hub.delta != NULL && count % HUB_FLUSH_SAMPLES == 0) FlushHubBuffer(hub);
+		if (chunk_start >= 0 && count % trace_chunk_samples == 0)
+		{
+			TraceEvent("line train chunk", chunk_start, TraceNow());
+			chunk_start = TraceNow();
+		}
 	}
+	if (hub.delta != NULL) FlushHubBuffer(hub);
+	PerfStop(&pc);
 	free(vec_error);
+	free(hub.delta);
+	free(hub.dirty);
+	free(hub.touched);
+	free(hub_source);
 	pthread_exit(NULL);
 }
 
-/* Read network from the training file */
+/* Read network from the training file, stopping early if the vertex ids overflow vid_t */
+template <typename vid_t, typename eid_t>
 static void VectorReadData(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v, const std::vector<double> &input_w)
 {
-	char name_v1[MAX_STRING], name_v2[MAX_STRING];
-	int vid;
+	long long vid;
 	double weight;
+	vid_t *&edge_source_id = LineIndex<vid_t, eid_t>::edge_source_id, *&edge_target_id = LineIndex<vid_t, eid_t>::edge_target_id;
 
 	num_edges = (long long) input_u.size();
 	//printf("Number of edges: %lld          \n", num_edges);
 
-	edge_source_id = (int *)malloc(num_edges*sizeof(int));
-	edge_target_id = (int *)malloc(num_edges*sizeof(int));
+	edge_source_id = (vid_t *)malloc(num_edges*sizeof(vid_t));
+	edge_target_id = (vid_t *)malloc(num_edges*sizeof(vid_t));
 	edge_weight = (double *)malloc(num_edges*sizeof(double));
 	if (edge_source_id == NULL || edge_target_id == NULL || edge_weight == NULL)
 	{
@@ -324,10 +442,9 @@ static void VectorReadData(const std::vector<std::string> &input_u, const std::v
 	}
 
 	num_vertices = 0;
-	for (int k = 0; k != num_edges; k++)
+	for (long long k = 0; k != num_edges; k++)
 	{
-		strcpy(name_v1, input_u[k].c_str());
-		strcpy(name_v2, input_v[k].c_str());
+		const char *name_v1 = input_u[k].c_str(), *name_v2 = input_v[k].c_str();
 		weight = input_w[k];
 
 		/*if (k % 10000 == 0)
@@ -336,33 +453,304 @@ static void VectorReadData(const std::vector<std::string> &input_u, const std::v
 			fflush(stdout);
 		}*/
 
-		vid = SearchHashTable(name_v1);
-		if (vid == -1) vid = AddVertex(name_v1);
+		vid = SearchHashTable<vid_t, eid_t>(name_v1);
+		if (vid == -1) vid = AddVertex<vid_t, eid_t>(name_v1);
+		if (vid == -1) return;
 		vertex[vid].degree += weight;
-		edge_source_id[k] = vid;
+		edge_source_id[k] = (vid_t)vid;
 
-		vid = SearchHashTable(name_v2);
-		if (vid == -1) vid = AddVertex(name_v2);
+		vid = SearchHashTable<vid_t, eid_t>(name_v2);
+		if (vid == -1) vid = AddVertex<vid_t, eid_t>(name_v2);
+		if (vid == -1) return;
 		vertex[vid].degree += weight;
-		edge_target_id[k] = vid;
+		edge_target_id[k] = (vid_t)vid;
 
 		edge_weight[k] = weight;
 	}
-	//printf("Number of vertices: %d          \n", num_vertices);
+	//printf("Number of vertices: %lld          \n", num_vertices);
+}
+
+// The edge list of a read on several threads, and the names interned from it
+struct ParallelRead {
+	const std::vector<std::string> *input_u, *input_v;
+	const std::vector<double> *input_w;
+	ShardedInterner *interner;
+	std::atomic<int> failed;               // a thread ran out of memory
+};
+
+static void InternEdges(long long begin, long long end, void *arg)
+{
+	ParallelRead *read = (ParallelRead *)arg;
+	for (long long k = begin; k != end && !read->failed.load(std::memory_order_relaxed); k++)
+		if (!InternerAdd(read->interner, (*read->input_u)[k].c_str(), 2 * k) ||
+		    !InternerAdd(read->interner, (*read->input_v)[k].c_str(), 2 * k + 1))
+			read->failed = 1;
+}
+
+template <typename vid_t, typename eid_t>
+static void FindEdgeIds(long long begin, long long end, void *arg)
+{
+	ParallelRead *read = (ParallelRead *)arg;
+	vid_t *edge_source_id = LineIndex<vid_t, eid_t>::edge_source_id, *edge_target_id = LineIndex<vid_t, eid_t>::edge_target_id;
+	for (long long k = begin; k != end; k++)
+	{
+		edge_source_id[k] = (vid_t)InternerFind(read->interner, (*read->input_u)[k].c_str());
+		edge_target_id[k] = (vid_t)InternerFind(read->interner, (*read->input_v)[k].c_str());
+		edge_weight[k] = (*read->input_w)[k];
+	}
+}
+
+/* Read network from the training file on threads threads. All threads intern the names into a
+   sharded dictionary at once, which numbers them by their first appearance afterwards, so the vertex
+   ids, names and degrees are exactly those of VectorReadData. Stops early if the vertex ids overflow
+   vid_t. */
+template <typename vid_t, typename eid_t>
+static void VectorReadDataParallel(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v, const std::vector<double> &input_w,
+								   int threads)
+{
+	vid_t *&edge_source_id = LineIndex<vid_t, eid_t>::edge_source_id, *&edge_target_id = LineIndex<vid_t, eid_t>::edge_target_id;
+
+	num_edges = (long long) input_u.size();
+	edge_source_id = (vid_t *)malloc(num_edges*sizeof(vid_t) + 1);
+	edge_target_id = (vid_t *)malloc(num_edges*sizeof(vid_t) + 1);
+	edge_weight = (double *)malloc(num_edges*sizeof(double) + 1);
+	ParallelRead read;
+	read.input_u = &input_u;
+	read.input_v = &input_v;
+	read.input_w = &input_w;
+	read.interner = InternerCreate();
+	read.failed = 0;
+	long long num_names = -1;
+	if (edge_source_id != NULL && edge_target_id != NULL && edge_weight != NULL && read.interner != NULL)
+	{
+		ParallelFor(num_edges, 1024, threads, InternEdges, &read);
+		if (!read.failed) num_names = InternerAssignIds(read.interner);
+	}
+	if (num_names > MaxVertexId<vid_t>())
+	{
+		index_overflow = 1;
+		InternerFree(read.interner);
+		return;
+	}
+	if (num_names != -1)
+	{
+		max_num_vertices = GrownVertexCapacity(num_names);
+		vertex = (struct ClassVertex *)calloc(max_num_vertices, sizeof(struct ClassVertex));
+	}
+	if (num_names == -1 || vertex == NULL)
+	{
+		Rprintf("Error: memory allocation failed!\n");
+		malloc_exit = 1;
+		InternerFree(read.interner);
+		return;
+	}
+
+	for (num_vertices = 0; num_vertices != num_names; num_vertices++)
+	{
+		vertex[num_vertices].name = ArenaStrdup(&vertex_names, InternerName(read.interner, num_vertices));
+		if (vertex[num_vertices].name == NULL)
+		{
+			Rprintf("Error: memory allocation failed!\n");
+			malloc_exit = 1;
+			InternerFree(read.interner);
+			return;
+		}
+	}
+	ParallelFor(num_edges, 1024, threads, FindEdgeIds<vid_t, eid_t>, &read);
+	InternerFree(read.interner);
+	// The degrees are summed in the order of the edges, as VectorReadData sums them
+	for (long long k = 0; k != num_edges; k++)
+	{
+		vertex[edge_source_id[k]].degree += edge_weight[k];
+		vertex[edge_target_id[k]].degree += edge_weight[k];
+	}
+}
+
+/* Read the edges of a compressed graph straight from its arrays, with the names of the graph as the
+   vertex names and without hashing any of them. Stops early if the vertex ids overflow vid_t. */
+template <typename vid_t, typename eid_t>
+static void VectorReadGraph(const CompressedGraph &graph)
+{
+	vid_t *&edge_source_id = LineIndex<vid_t, eid_t>::edge_source_id, *&edge_target_id = LineIndex<vid_t, eid_t>::edge_target_id;
+
+	num_edges = graph.num_edges;
+	long long *id = (long long *)malloc(graph.num_vertices * sizeof(long long) + 1);
+	edge_source_id = (vid_t *)malloc(num_edges*sizeof(vid_t) + 1);
+	edge_target_id = (vid_t *)malloc(num_edges*sizeof(vid_t) + 1);
+	edge_weight = (double *)malloc(num_edges*sizeof(double) + 1);
+	if (id == NULL || edge_source_id == NULL || edge_target_id == NULL || edge_weight == NULL)
+	{
+		Rprintf("Error: memory allocation failed!\n");
+		malloc_exit = 1;
+		free(id);
+		return;
+	}
+
+	num_vertices = CompactGraphVertices(graph, id);
+	if (num_vertices > MaxVertexId<vid_t>())
+	{
+		index_overflow = 1;
+		free(id);
+		return;
+	}
+	vertex = (struct ClassVertex *)calloc(num_vertices + 1, sizeof(struct ClassVertex));
+	if (vertex == NULL)
+	{
+		Rprintf("Error: memory allocation failed!\n");
+		malloc_exit = 1;
+		free(id);
+		return;
+	}
+	for (long long k = 0; k != graph.num_vertices; k++) if (id[k] != -1) vertex[id[k]].name = (char *)graph.names[k];
+	for (long long j = 0; j != graph.num_vertices; j++)
+		for (long long e = graph.col_ptr[j]; e != graph.col_ptr[j + 1]; e++)
+		{
+			long long u = id[graph.row[e]], v = id[j];
+			double weight = graph.weight[e];
+			vertex[u].degree += weight;
+			vertex[v].degree += weight;
+			edge_source_id[e] = (vid_t)u;
+			edge_target_id[e] = (vid_t)v;
+			edge_weight[e] = weight;
+		}
+	free(id);
+}
+
+/* Read the edges of a binary edge file straight from its records, with the name table of the file
+   as the vertex names, so that neither the edges nor the names are parsed or hashed */
+template <typename vid_t, typename eid_t>
+static void VectorReadEdges(const EdgeFile &edge_file)
+{
+	vid_t *&edge_source_id = LineIndex<vid_t, eid_t>::edge_source_id, *&edge_target_id = LineIndex<vid_t, eid_t>::edge_target_id;
+
+	num_edges = edge_file.num_edges;
+	num_vertices = edge_file.num_vertices;
+	vertex = (struct ClassVertex *)calloc(num_vertices + 1, sizeof(struct ClassVertex));
+	edge_source_id = (vid_t *)malloc(num_edges*sizeof(vid_t) + 1);
+	edge_target_id = (vid_t *)malloc(num_edges*sizeof(vid_t) + 1);
+	edge_weight = (double *)malloc(num_edges*sizeof(double) + 1);
+	if (vertex == NULL || edge_source_id == NULL || edge_target_id == NULL || edge_weight == NULL)
+	{
+		Rprintf("Error: memory allocation failed!\n");
+		malloc_exit = 1;
+		return;
+	}
+	for (long long k = 0; k != num_vertices; k++) vertex[k].name = (char *)edge_file.names[k];
+	for (long long e = 0; e != num_edges; e++)
+	{
+		const EdgeRecord &r = edge_file.edges[e];
+		vertex[r.source].degree += r.weight;
+		vertex[r.target].degree += r.weight;
+		edge_source_id[e] = (vid_t)r.source;
+		edge_target_id[e] = (vid_t)r.target;
+		edge_weight[e] = r.weight;
+	}
+}
+
+/* Read the edges of an Arrow record batch from its columns in place, with the vertices numbered as
+   VectorReadData numbers them */
+template <typename vid_t, typename eid_t>
+static void VectorReadArrow(const ArrowEdges &arrow_edges)
+{
+	vid_t *&edge_source_id = LineIndex<vid_t, eid_t>::edge_source_id, *&edge_target_id = LineIndex<vid_t, eid_t>::edge_target_id;
+	const long long chunk = 1024;
+	long long source[chunk], target[chunk];
+
+	num_edges = arrow_edges.num_edges;
+	num_vertices = arrow_edges.num_vertices;
+	if (num_vertices > MaxVertexId<vid_t>())
+	{
+		index_overflow = 1;
+		return;
+	}
+	vertex = (struct ClassVertex *)calloc(num_vertices + 1, sizeof(struct ClassVertex));
+	edge_source_id = (vid_t *)malloc(num_edges*sizeof(vid_t) + 1);
+	edge_target_id = (vid_t *)malloc(num_edges*sizeof(vid_t) + 1);
+	edge_weight = (double *)malloc(num_edges*sizeof(double) + 1);
+	if (vertex == NULL || edge_source_id == NULL || edge_target_id == NULL || edge_weight == NULL)
+	{
+		Rprintf("Error: memory allocation failed!\n");
+		malloc_exit = 1;
+		return;
+	}
+	for (long long k = 0; k != num_vertices; k++) vertex[k].name = (char *)arrow_edges.names[k];
+	for (long long begin = 0; begin < num_edges; begin += chunk)
+	{
+		long long end = begin + chunk < num_edges ? begin + chunk : num_edges;
+		ArrowEdgesRead(arrow_edges, begin, end, source, target, edge_weight + begin);
+		for (long long e = begin; e != end; e++)
+		{
+			vertex[source[e - begin]].degree += edge_weight[e];
+			vertex[target[e - begin]].degree += edge_weight[e];
+			edge_source_id[e] = (vid_t)source[e - begin];
+			edge_target_id[e] = (vid_t)target[e - begin];
+		}
+	}
+}
+
+/* Release everything that is only needed for training, before the embeddings are copied out */
+template <typename vid_t, typename eid_t>
+static void FreeTraining()
+{
+	typedef LineIndex<vid_t, eid_t> Index;
+	free(Index::edge_source_id); Index::edge_source_id = NULL;
+	free(Index::edge_target_id); Index::edge_target_id = NULL;
+	free(edge_weight); edge_weight = NULL;
+	if (!alias_borrowed)
+	{
+		HugeFree(Index::alias);
+		HugeFree(prob);
+	}
+	Index::alias = NULL;
+	prob = NULL;
+	alias_borrowed = 0;
+	HugeFree(Index::neg_table); Index::neg_table = NULL;
+	free(hub_index); hub_index = NULL;
+	free(hub_vertex); hub_vertex = NULL;
+	HugeFree(emb_context); emb_context = NULL;
+	free(sigmoid_table); sigmoid_table = NULL;
+	if (gsl_r != NULL) gsl_rng_free(gsl_r);
+	gsl_r = NULL;
+}
+
+/* Release all state of a run, so that a failed run leaves nothing half built behind */
+template <typename vid_t, typename eid_t>
+static void FreeLINE()
+{
+	FreeTraining<vid_t, eid_t>();
+	free(LineIndex<vid_t, eid_t>::vertex_hash_table); LineIndex<vid_t, eid_t>::vertex_hash_table = NULL;
+	HugeFree(emb_vertex); emb_vertex = NULL;
+	ArenaRelease(&vertex_names);
+	free(vertex); vertex = NULL;
+	num_vertices = 0;
+	max_num_vertices = initial_vertex_capacity;
+}
+
+/* Average vertex name length, estimated from the first edges */
+static double AverageNameLength(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v)
+{
+	long long n = input_u.size() < 10000 ? (long long)input_u.size() : 10000, length = 0;
+	for (long long k = 0; k != n; k++) length += input_u[k].size() + input_v[k].size();
+	return n == 0 ? 0 : (double)length / (2 * n);
 }
 
 static void VectorOutput(std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors)
 {
-	for (int a = 0; a < num_vertices; a++)
+	for (long long a = 0; a < num_vertices; a++)
 	{
 		output_vertices.push_back(std::string(vertex[a].name));
 		std::vector<double> vec;
 		for (int b = 0; b < dim; b++) {
-			vec.push_back(emb_vertex[a * dim + b]);
+			vec.push_back(emb_vertex[a * row_stride + b]);
 		}
 		output_vectors.push_back(vec);
 	}
 }
+static void VectorOutputContext(std::vector< std::vector<double> > &output_context)
+{
+	for (long long a = 0; a < num_vertices; a++)
+		output_context.push_back(std::vector<double>(emb_context + a * row_stride, emb_context + a * row_stride + dim));
+}
 /*
 static void OutputVectors(std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors)
 {
@@ -379,23 +767,129 @@ static void OutputVectors(std::vector<std::string> &output_vertices, std::vector
 }
 */
 
-void TrainLINEMain(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v, const std::vector<double> &input_w, std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors,
-				  int is_binary_param, int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param, int num_threads_param) {
+/* Train with vid_t vertex ids and eid_t edge ids on the edges of graph, edge_file or arrow_edges, or of input_u,
+   input_v and input_w when all are NULL; returns 0 without training if the vertex ids overflow vid_t */
+template <typename vid_t, typename eid_t>
+static int TrainLINE(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v, const std::vector<double> &input_w,
+				  const CompressedGraph *graph, const EdgeFile *edge_file, const ArrowEdges *arrow_edges,
+				  std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors,
+				  LineMemoryPlan &plan, double name_length)
+{
+	long a;
+	int readers = read_threads > 0 ? read_threads : num_threads;
+	hash_table_size = plan.hash_table_size;
+	neg_table_size = plan.neg_table_size;
+	index_overflow = 0;
+
+    GetRNGstate();
+	PerfCounters pc;
+	PerfStart(&pc, line_memory_phase_names[LINE_READ_DATA]);
+	if (graph != NULL) VectorReadGraph<vid_t, eid_t>(*graph);
+	else if (edge_file != NULL) VectorReadEdges<vid_t, eid_t>(*edge_file);
+	else if (arrow_edges != NULL) VectorReadArrow<vid_t, eid_t>(*arrow_edges);
+	else if (readers > 1) VectorReadDataParallel<vid_t, eid_t>(input_u, input_v, input_w, readers);
+	else
+	{
+		vertex = (struct ClassVertex *)calloc(max_num_vertices, sizeof(struct ClassVertex));
+		InitHashTable<vid_t, eid_t>();
+		if (vertex == NULL || LineIndex<vid_t, eid_t>::vertex_hash_table == NULL)
+		{
+			Rprintf("Error: memory allocation failed!\n");
+			malloc_exit = 1;
+		}
+		else VectorReadData<vid_t, eid_t>(input_u, input_v, input_w); 
+		free(LineIndex<vid_t, eid_t>::vertex_hash_table);
+		LineIndex<vid_t, eid_t>::vertex_hash_table = NULL;
+	}
+	PerfStop(&pc);
+	if (index_overflow) { FreeLINE<vid_t, eid_t>(); PutRNGstate(); return 0; }
+	if (malloc_exit != 0) { FreeLINE<vid_t, eid_t>(); PutRNGstate(); return 1; }
+
+	int fits = PlanLINEMemory(&plan, num_edges, num_vertices, name_length, dim, order, num_threads, memory_budget, sizeof(vid_t), sizeof(eid_t),
+		hub_vertices);
+	if (memory_budget > 0) PrintLINEMemoryPlan(&plan);
+	if (!fits)
+	{
+		Rprintf("Error: line needs more memory than the budget!\n");
+		FreeLINE<vid_t, eid_t>();
+		PutRNGstate();
+		return 1;
+	}
+	neg_table_size = plan.neg_table_size;
+
+	PerfStart(&pc, line_memory_phase_names[LINE_ALIAS_TABLE]);
+	InitAliasTable<vid_t, eid_t>(graph);
+	free(edge_weight);
+	edge_weight = NULL;
+	PerfStop(&pc);
+	if (malloc_exit != 0) { FreeLINE<vid_t, eid_t>(); PutRNGstate(); return 1; }
+	PerfStart(&pc, line_memory_phase_names[LINE_INIT_VECTORS]);
+	InitVector();
+	PerfStop(&pc);
+	if (malloc_exit != 0) { FreeLINE<vid_t, eid_t>(); PutRNGstate(); return 1; }
+	PerfStart(&pc, line_memory_phase_names[LINE_NEG_TABLE]);
+	InitNegTable<vid_t, eid_t>();
+	InitHubTable();
+	PerfStop(&pc);
+	if (malloc_exit != 0) { FreeLINE<vid_t, eid_t>(); PutRNGstate(); return 1; }
+
+	PerfStart(&pc, line_memory_phase_names[LINE_TRAIN]);
+	pthread_t *pt = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+	sigmoid_table = (real *)malloc((sigmoid_table_size + 1) * sizeof(real));
+	InitSigmoidTable(sigmoid_table);
+
+	gsl_rng_env_setup();
+	gsl_T = gsl_rng_rand48;
+	gsl_r = gsl_rng_alloc(gsl_T);
+	gsl_rng_set(gsl_r, 314159265);
+    
+    Rprintf ("generator type: %s\n", gsl_rng_name (gsl_r));
+    Rprintf ("seed = %lu\n", gsl_rng_default_seed);
+    Rprintf ("first value = %lu\n", gsl_rng_get (gsl_r));
+	clock_t start = clock();
+	//printf("--------------------------------\n");
+	for (a = 0; a < num_threads; a++) pthread_create(&pt[a], NULL, TrainLINEThread<vid_t, eid_t>, (void *)a);
+	for (a = 0; a < num_threads; a++) pthread_join(pt[a], NULL);
+	free(pt);
+	PerfStop(&pc);
+	//printf("\n");
+    PutRNGstate();
+	clock_t finish = clock();
+	//printf("Total time: %lf\n", (double)(finish - start) / CLOCKS_PER_SEC);
+
+	PerfStart(&pc, line_memory_phase_names[LINE_OUTPUT]);
+	if (output_context_vectors != NULL && order == 2) VectorOutputContext(*output_context_vectors);
+	FreeTraining<vid_t, eid_t>();
+	VectorOutput(output_vertices, output_vectors); //Output();
+	FreeLINE<vid_t, eid_t>();
+	PerfStop(&pc);
+	return 1;
+}
+
+static void LINEMain(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v, const std::vector<double> &input_w,
+				  const CompressedGraph *graph, const EdgeFile *edge_file, const ArrowEdges *arrow_edges,
+				  std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors,
+				  int is_binary_param, int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param, int num_threads_param,
+				  long long memory_budget_param, std::vector< std::vector<double> > *output_context, long long hub_vertices_param,
+				  int huge_pages_param) {
+	PerfReset();
 	is_binary = is_binary_param;
 	dim = dim_param;
+	row_stride = PaddedRowStride(dim);
 	order = order_param;
 	num_negative = num_negative_param;
 	total_samples = total_samples_param;
 	init_rho = init_rho_param;
 	num_threads = num_threads_param;
+	memory_budget = memory_budget_param;
+	output_context_vectors = output_context;
+	hub_vertices = hub_vertices_param;
+	huge_pages = huge_pages_param;
 	current_sample_count = 0;
-    GetRNGstate();
 
 	total_samples *= 1000000;
 	rho = init_rho;
-	vertex = (struct ClassVertex *)calloc(max_num_vertices, sizeof(struct ClassVertex));
-	long a;
-	pthread_t *pt = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+	malloc_exit = 0;
 
 	if (order != 1 && order != 2)
 	{
@@ -412,34 +906,178 @@ void TrainLINEMain(const std::vector<std::string> &input_u, const std::vector<st
 	printf("Threads: %d\n", num_threads);
 	printf("--------------------------------\n");
     */
-	InitHashTable();
-	VectorReadData(input_u, input_v, input_w); 
-	if (malloc_exit != 0) { return; }
-	InitAliasTable();
-	if (malloc_exit != 0) { return; }
-	InitVector();
-	if (malloc_exit != 0) { return; }
-	InitNegTable();
-	InitSigmoidTable();
+	// 32-bit edge ids are enough when there are fewer than 2^31 edges. Vertex ids start out 32-bit
+	// too, and the edges are read again with 64-bit vertex ids if there turn out to be more vertices.
+	long long edges = graph != NULL ? graph->num_edges : edge_file != NULL ? edge_file->num_edges :
+		arrow_edges != NULL ? arrow_edges->num_edges : (long long)input_u.size();
+	int edge_ids_fit = edges < (long long)std::numeric_limits<int>::max();
 
-	gsl_rng_env_setup();
-	gsl_T = gsl_rng_rand48;
-	gsl_r = gsl_rng_alloc(gsl_T);
-	gsl_rng_set(gsl_r, 314159265);
-    
-    Rprintf ("generator type: %s\n", gsl_rng_name (gsl_r));
-    Rprintf ("seed = %lu\n", gsl_rng_default_seed);
-    Rprintf ("first value = %lu\n", gsl_rng_get (gsl_r));
-	clock_t start = clock();
-	//printf("--------------------------------\n");
-	for (a = 0; a < num_threads; a++) pthread_create(&pt[a], NULL, TrainLINEThread, (void *)a);
-	for (a = 0; a < num_threads; a++) pthread_join(pt[a], NULL);
-	//printf("\n");
-    PutRNGstate();
-	clock_t finish = clock();
-	//printf("Total time: %lf\n", (double)(finish - start) / CLOCKS_PER_SEC);
+	// Check the plan before allocating anything, with twice the number of edges as an upper bound
+	// on the number of vertices. If that does not fit, read the edges and check the exact plan.
+	LineMemoryPlan plan;
+	double name_length = graph != NULL ? GraphNameLength(*graph) : edge_file != NULL ? EdgeFileNameLength(*edge_file) :
+		arrow_edges != NULL ? ArrowEdgesNameLength(*arrow_edges) : AverageNameLength(input_u, input_v);
+	long long vertices = graph != NULL && graph->num_vertices < 2 * edges ? graph->num_vertices : 2 * edges;
+	if (edge_file != NULL) vertices = edge_file->num_vertices;
+	if (arrow_edges != NULL) vertices = arrow_edges->num_vertices;
+	int fits = PlanLINEMemory(&plan, edges, vertices, name_length, dim, order, num_threads, memory_budget,
+		sizeof(int), edge_ids_fit ? sizeof(int) : sizeof(long long), hub_vertices);
+	if (!fits && plan.live[LINE_READ_DATA] > memory_budget)
+	{
+		PrintLINEMemoryPlan(&plan);
+		Rprintf("Error: reading the edges alone needs more memory than the budget!\n");
+		return;
+	}
 
-	VectorOutput(output_vertices, output_vectors); //Output();
+	int done = edge_ids_fit ? TrainLINE<int, int>(input_u, input_v, input_w, graph, edge_file, arrow_edges, output_vertices, output_vectors, plan, name_length)
+		: TrainLINE<int, long long>(input_u, input_v, input_w, graph, edge_file, arrow_edges, output_vertices, output_vectors, plan, name_length);
+	if (!done)
+	{
+		Rprintf("More than %lld vertices, reading the edges again with 64-bit vertex ids\n", vertex_id_limit);
+		TrainLINE<long long, long long>(input_u, input_v, input_w, graph, edge_file, arrow_edges, output_vertices, output_vectors, plan, name_length);
+	}
+	PerfPrint();
+}
+
+void TrainLINEMain(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v, const std::vector<double> &input_w, std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors,
+				  int is_binary_param, int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param, int num_threads_param,
+				  long long memory_budget_param, std::vector< std::vector<double> > *output_context, long long hub_vertices_param,
+				  int huge_pages_param) {
+	TRACE_SCOPE("TrainLINEMain");
+	LINEMain(input_u, input_v, input_w, NULL, NULL, NULL, output_vertices, output_vectors, is_binary_param, dim_param, order_param, num_negative_param,
+		total_samples_param, init_rho_param, num_threads_param, memory_budget_param, output_context, hub_vertices_param, huge_pages_param);
+}
+
+/* Train on the edges of a compressed graph; the vertices without edges get no row */
+void TrainLINEGraphMain(const CompressedGraph &graph, std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors,
+				  int is_binary_param, int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param, int num_threads_param,
+				  long long memory_budget_param, std::vector< std::vector<double> > *output_context, long long hub_vertices_param,
+				  int huge_pages_param) {
+	TRACE_SCOPE("TrainLINEGraphMain");
+	std::vector<std::string> no_names;
+	std::vector<double> no_weights;
+	LINEMain(no_names, no_names, no_weights, &graph, NULL, NULL, output_vertices, output_vectors, is_binary_param, dim_param, order_param, num_negative_param,
+		total_samples_param, init_rho_param, num_threads_param, memory_budget_param, output_context, hub_vertices_param, huge_pages_param);
+}
+
+/* Train on the edges of a binary edge file; every vertex of its name table gets a row */
+void TrainLINEEdgeFileMain(const EdgeFile &edge_file, std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors,
+				  int is_binary_param, int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param, int num_threads_param,
+				  long long memory_budget_param, std::vector< std::vector<double> > *output_context, long long hub_vertices_param,
+				  int huge_pages_param) {
+	TRACE_SCOPE("TrainLINEEdgeFileMain");
+	std::vector<std::string> no_names;
+	std::vector<double> no_weights;
+	LINEMain(no_names, no_names, no_weights, NULL, &edge_file, NULL, output_vertices, output_vectors, is_binary_param, dim_param, order_param, num_negative_param,
+		total_samples_param, init_rho_param, num_threads_param, memory_budget_param, output_context, hub_vertices_param, huge_pages_param);
+}
+
+/* Train on the edges of an Arrow record batch */
+void TrainLINEArrowMain(const ArrowEdges &arrow_edges, std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors,
+				  int is_binary_param, int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param, int num_threads_param,
+				  long long memory_budget_param, std::vector< std::vector<double> > *output_context, long long hub_vertices_param,
+				  int huge_pages_param) {
+	TRACE_SCOPE("TrainLINEArrowMain");
+	std::vector<std::string> no_names;
+	std::vector<double> no_weights;
+	LINEMain(no_names, no_names, no_weights, NULL, NULL, &arrow_edges, output_vertices, output_vectors, is_binary_param, dim_param, order_param, num_negative_param,
+		total_samples_param, init_rho_param, num_threads_param, memory_budget_param, output_context, hub_vertices_param, huge_pages_param);
+}
+
+/* Let line take the 64-bit vertex ids once a graph has more than limit vertices, instead of 2^31 - 1, so
+   that tests can take that path on a small graph; a limit below 1 restores the default. Returns the
+   previous limit. */
+long long LINEVertexIdLimit(long long limit)
+{
+	long long previous = vertex_id_limit;
+	vertex_id_limit = limit < 1 || limit > std::numeric_limits<int>::max() ? std::numeric_limits<int>::max() : limit;
+	return previous;
+}
+
+/* Let line read a data frame on threads threads whatever the number of training threads, so that
+   tests can compare the parallel read with the serial one on a single training thread; 0 restores
+   reading on the training threads. Returns the previous setting. */
+int LINEReadThreads(int threads)
+{
+	int previous = read_threads;
+	read_threads = threads < 0 ? 0 : threads;
+	return previous;
+}
+
+/* Read the next line of fi into line, however long it is; returns 0 at the end of the file */
+static int ReadLine(FILE *fi, std::string &line)
+{
+	char buffer[4096];
+	line.clear();
+	while (fgets(buffer, sizeof(buffer), fi) != NULL)
+	{
+		line += buffer;
+		if (line[line.size() - 1] == '\n') return 1;
+	}
+	return !line.empty();
+}
+
+/* Convert a text edge list of "<u> <v> <w>" lines to a binary edge file. The names are interned with the
+   hash table line reads its edges with, so the vertex ids of the file are the ones line would give the
+   vertices. Returns 0 with a description in *error if the conversion fails. */
+int ConvertEdgeListMain(const char *text_file, const char *binary_file, const char **error)
+{
+	TRACE_SCOPE("ConvertEdgeListMain");
+	static char message[MAX_STRING + 64];
+	FILE *fi = fopen(text_file, "rb");
+	if (fi == NULL)
+	{
+		*error = "the text edge list cannot be read";
+		return 0;
+	}
+	EdgeFileWriter writer;
+	if (!EdgeFileBegin(&writer, binary_file))
+	{
+		fclose(fi);
+		*error = "the binary edge file cannot be written";
+		return 0;
+	}
+
+	hash_table_size = default_hash_table_size;
+	malloc_exit = index_overflow = 0;
+	vertex = (struct ClassVertex *)calloc(max_num_vertices, sizeof(struct ClassVertex));
+	InitHashTable<int, int>();
+	*error = NULL;
+	if (vertex == NULL || LineIndex<int, int>::vertex_hash_table == NULL) *error = "memory allocation failed";
+
+	std::string line;
+	const char *separators = " \t\r\n";
+	for (long long line_number = 1; *error == NULL && ReadLine(fi, line); line_number++)
+	{
+		char *fields[4], *rest = &line[0];
+		int num_fields = 0;
+		for (char *field = strtok(rest, separators); field != NULL && num_fields != 4; field = strtok(NULL, separators))
+			fields[num_fields++] = field;
+		if (num_fields == 0) continue;
+		char *end = NULL;
+		double weight = num_fields == 3 ? strtod(fields[2], &end) : 0;
+		if (num_fields != 3 || end == fields[2] || *end != 0)
+		{
+			snprintf(message, sizeof(message), "line %lld of the text edge list is not \"<u> <v> <w>\"", line_number);
+			*error = message;
+			break;
+		}
+		long long ends[2];
+		for (int i = 0; i != 2; i++)
+		{
+			ends[i] = SearchHashTable<int, int>(fields[i]);
+			if (ends[i] == -1) ends[i] = AddVertex<int, int>(fields[i]);
+		}
+		if (index_overflow) *error = "the edge list has more than 2^31 - 1 vertices";
+		else if (malloc_exit) *error = "memory allocation failed";
+		else EdgeFileAppend(&writer, ends[0], ends[1], weight);
+	}
+	fclose(fi);
+	for (long long k = 0; *error == NULL && k != num_vertices; k++) EdgeFileAppendName(&writer, vertex[k].name);
+	if (*error != NULL) EdgeFileAbort(&writer);
+	else if (!EdgeFileEnd(&writer)) *error = "the binary edge file cannot be written";
+	FreeLINE<int, int>();
+	return *error == NULL;
 }
 /*
 static void ReadVectors(std::vector<std::string> &input_u, std::vector<std::string> &input_v, std::vector<double> &input_w) {
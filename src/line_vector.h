@@ -1,11 +1,31 @@
 #include <vector>
 #include <string>
+#include "compressed_graph.h"
+#include "edge_file.h"
+#include "arrow_data.h"
 
 #ifndef LINE_H
 #define LINE_H
 
 void TrainLINEMain(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v, const std::vector<double> &input_w, 
 					std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors, int is_binary_param, 
-					int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param, int num_threads_param);
+					int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param, int num_threads_param,
+					long long memory_budget_param = 0, std::vector< std::vector<double> > *output_context = NULL,
+					long long hub_vertices_param = 0, int huge_pages_param = 1);
+void TrainLINEGraphMain(const CompressedGraph &graph, std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors,
+					int is_binary_param, int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param,
+					int num_threads_param, long long memory_budget_param = 0, std::vector< std::vector<double> > *output_context = NULL,
+					long long hub_vertices_param = 0, int huge_pages_param = 1);
+void TrainLINEEdgeFileMain(const EdgeFile &edge_file, std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors,
+					int is_binary_param, int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param,
+					int num_threads_param, long long memory_budget_param = 0, std::vector< std::vector<double> > *output_context = NULL,
+					long long hub_vertices_param = 0, int huge_pages_param = 1);
+void TrainLINEArrowMain(const ArrowEdges &arrow_edges, std::vector<std::string> &output_vertices, std::vector< std::vector<double> > &output_vectors,
+					int is_binary_param, int dim_param, int order_param, int num_negative_param, int total_samples_param, float init_rho_param,
+					int num_threads_param, long long memory_budget_param = 0, std::vector< std::vector<double> > *output_context = NULL,
+					long long hub_vertices_param = 0, int huge_pages_param = 1);
+long long LINEVertexIdLimit(long long limit);
+int LINEReadThreads(int threads);
+int ConvertEdgeListMain(const char *text_file, const char *binary_file, const char **error);
 #endif
 
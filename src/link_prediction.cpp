@@ -0,0 +1,204 @@
+/*
+Link prediction evaluation of an embedding on held-out edges.
+
+Every held-out edge (u, v) is a positive pair and is corrupted into negative pairs (u, v') by
+drawing v' from the degree^0.75 negative sampling table that line trains with. Pairs are scored
+by the dot product of the (optionally normalized) rows on several threads. The random numbers
+of an edge are drawn from a generator seeded by the edge number, so the result does not depend
+on the number of threads.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <R.h>
+#include "perf_counters.h"
+#include "trace.h"
+#include "simd.h"
+#include "parallel.h"
+#include "sampling.h"
+#include "memory_planner.h"
+#include "link_prediction.h"
+
+#define ROW_BLOCK 512
+#define EDGE_BLOCK 4096
+#define MAX_REDRAWS 16            // draws before a negative equal to u or v is kept anyway
+
+// A scored pair; positives sort after negatives with the same score, which does not change the
+// result because ties are counted as halves
+struct ScoredPair {
+	double score;
+	int label;
+	friend bool operator < (const ScoredPair &a, const ScoredPair &b)
+	{
+		return a.score < b.score || (a.score == b.score && a.label < b.label);
+	}
+};
+
+static long long num_rows = 0, vector_dim = 0, num_pairs_per_edge = 1, neg_table_size = 0;
+static int normalize = 1;
+static const double *vec;
+static const int *edge_source, *edge_target;
+static const double *vertex_degree;
+static double *rows;                  // num_rows x vector_dim, row-major
+static int *neg_table;
+static unsigned long long base_seed = 0;
+static ScoredPair *pairs;
+
+/* Copy rows [begin, end) into row-major order, normalized when asked */
+static void PackTask(long long begin, long long end, void *arg)
+{
+	for (long long c = 0; c != vector_dim; c++)
+		for (long long r = begin; r != end; r++) rows[r * vector_dim + c] = vec[c * num_rows + r];
+	if (!normalize) return;
+	for (long long r = begin; r != end; r++)
+	{
+		double *row = rows + r * vector_dim, len = sqrt(SimdDot(row, row, vector_dim));
+		if (len > 0) for (long long c = 0; c != vector_dim; c++) row[c] /= len;
+	}
+}
+
+// NaN scores would break the sort; they rank below every other pair
+static inline double Score(const double *a, const double *b)
+{
+	double score = SimdDot(a, b, vector_dim);
+	return score == score ? score : -INFINITY;
+}
+
+static double Degree(long long k)
+{
+	return vertex_degree[k];
+}
+
+static double UnitDegree(long long k)
+{
+	return 1;
+}
+
+/* Score the held-out edges [begin, end) and their negatives */
+static void ScoreTask(long long begin, long long end, void *arg)
+{
+	long long num_edges = *(long long *)arg;
+	for (long long e = begin; e != end; e++)
+	{
+		long long u = edge_source[e], v = edge_target[e];
+		const double *row_u = rows + u * vector_dim;
+		unsigned long long seed = base_seed + (unsigned long long)e * 0x9E3779B97F4A7C15ULL;
+
+		pairs[e].score = Score(row_u, rows + v * vector_dim);
+		pairs[e].label = 1;
+		for (long long n = 0; n != num_pairs_per_edge - 1; n++)
+		{
+			long long target = neg_table[FastRand(seed, neg_table_size)];
+			for (int d = 1; d != MAX_REDRAWS && (target == u || target == v); d++) target = neg_table[FastRand(seed, neg_table_size)];
+			ScoredPair &pair = pairs[num_edges + e * (num_pairs_per_edge - 1) + n];
+			pair.score = Score(row_u, rows + target * vector_dim);
+			pair.label = 0;
+		}
+	}
+}
+
+/* AUC of the sorted pairs, counting a positive tied with a negative as half a correct order, and
+   the fraction of positives among the k best pairs, splitting the tied group at the cut evenly */
+static void Summarize(const ScoredPair *sorted, long long n, const std::vector<long long> &ks, LinkPredictionResult &result)
+{
+	double correct = 0, negatives_below = 0;
+	for (long long b = 0; b != n;)
+	{
+		long long e = b, pos = 0;
+		while (e != n && sorted[e].score == sorted[b].score) pos += sorted[e++].label;
+		long long neg = e - b - pos;
+		correct += pos * (negatives_below + 0.5 * neg);
+		negatives_below += neg;
+		b = e;
+	}
+	result.auc = result.num_positive == 0 || result.num_negative == 0 ? NAN : correct / ((double)result.num_positive * result.num_negative);
+
+	result.precision.assign(ks.size(), NAN);
+	for (size_t i = 0; i != ks.size(); i++)
+	{
+		long long k = ks[i] < n ? ks[i] : n;
+		if (k <= 0) continue;
+		double hits = 0;
+		long long taken = 0;
+		for (long long e = n; taken != k;)
+		{
+			long long b = e, pos = 0;
+			while (b != 0 && sorted[b - 1].score == sorted[e - 1].score) pos += sorted[--b].label;
+			long long group = e - b, take = group < k - taken ? group : k - taken;
+			hits += (double)pos * take / group;
+			taken += take;
+			e = b;
+		}
+		result.precision[i] = hits / k;
+	}
+}
+
+/* Evaluate a column-major rows x dim embedding on num_edges held-out edges given as 0-based rows,
+   with negative negatives per edge drawn by degree, the weighted degree of every row */
+void LinkPredictionMain(const double *embedding, long long rows_param, long long dim, const int *source, const int *target, long long num_edges,
+                        const double *degree, int negative, int normalize_param, unsigned long long seed, const std::vector<long long> &ks,
+                        int num_threads, LinkPredictionResult &result)
+{
+	TRACE_SCOPE("LinkPredictionMain");
+	PerfReset();
+	num_rows = rows_param;
+	vector_dim = dim;
+	num_pairs_per_edge = 1 + (negative > 0 ? negative : 0);
+	normalize = normalize_param;
+	vec = embedding;
+	edge_source = source;
+	edge_target = target;
+	vertex_degree = degree;
+	base_seed = seed;
+	result.num_positive = num_edges;
+	result.num_negative = num_edges * (num_pairs_per_edge - 1);
+
+	// The table only has to resolve the share of every vertex, not hold line's 1e8 entries
+	neg_table_size = 100 * num_rows;
+	if (neg_table_size < min_neg_table_size) neg_table_size = min_neg_table_size;
+	if (neg_table_size > default_neg_table_size) neg_table_size = default_neg_table_size;
+
+	long long num_pairs = num_edges * num_pairs_per_edge;
+	rows = (double *)malloc(num_rows * vector_dim * sizeof(double) + 1);
+	neg_table = (int *)malloc(neg_table_size * sizeof(int));
+	pairs = (ScoredPair *)malloc(num_pairs * sizeof(ScoredPair) + 1);
+	if (rows == NULL || neg_table == NULL || pairs == NULL)
+	{
+		Rprintf("Error: memory allocation failed\n");
+		result.auc = NAN;
+		result.precision.assign(ks.size(), NAN);
+		free(rows);
+		free(neg_table);
+		free(pairs);
+		return;
+	}
+
+	PerfCounters pc;
+	PerfStart(&pc, "link prediction setup");
+	ParallelFor(num_rows, ROW_BLOCK, num_threads, PackTask, NULL);
+	double sum = 0;
+	for (long long k = 0; k != num_rows; k++) sum += degree[k];
+	if (sum > 0) FillNegTable(neg_table, neg_table_size, num_rows, Degree);
+	else FillNegTable(neg_table, neg_table_size, num_rows, UnitDegree);
+	PerfStop(&pc);
+
+	PerfStart(&pc, "link prediction score");
+	ParallelFor(num_edges, EDGE_BLOCK, num_threads, ScoreTask, &num_edges);
+	PerfStop(&pc);
+
+	PerfStart(&pc, "link prediction summary");
+	std::sort(pairs, pairs + num_pairs);
+	Summarize(pairs, num_pairs, ks, result);
+	PerfStop(&pc);
+	PerfPrint();
+
+	free(rows);
+	free(neg_table);
+	free(pairs);
+	rows = NULL;
+	neg_table = NULL;
+	pairs = NULL;
+}
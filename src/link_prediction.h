@@ -0,0 +1,15 @@
+#include <vector>
+
+#ifndef LINK_PREDICTION_H
+#define LINK_PREDICTION_H
+
+struct LinkPredictionResult {
+	double auc;
+	std::vector<double> precision;         // precision at each of the requested k
+	long long num_positive, num_negative;
+};
+
+void LinkPredictionMain(const double *embedding, long long rows, long long dim, const int *source, const int *target, long long num_edges,
+                        const double *degree, int negative, int normalize, unsigned long long seed, const std::vector<long long> &ks,
+                        int num_threads, LinkPredictionResult &result);
+#endif
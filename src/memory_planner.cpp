@@ -0,0 +1,163 @@
+/*
+Memory planner for the line algorithm.
+
+Computes the bytes each phase of TrainLINEMain allocates and the bytes that are live at the
+peak of each phase from the number of edges and vertices, the dimension and the chosen
+representations. When the plan does not fit in the memory budget, cheaper representations
+are chosen, first a hash table sized for the vertices instead of the fixed default and then
+a smaller negative sampling table, before giving up.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <vector>
+#include <string>
+#include <R.h>
+#include "line_kernel.h"
+#include "memory_planner.h"
+#include "arena.h"
+#include "intern.h"
+
+// Bytes of an R CHARSXP header, used for the row names of the output matrix
+#define R_STRING_OVERHEAD 56
+
+const char *line_memory_phase_names[LINE_NUM_PHASES] = { "line read data", "line alias table", "line init vectors",
+	"line negative table", "line train", "line output" };
+
+static LineMemoryPlan last_plan;
+
+static long long Max(long long a, long long b)
+{
+	return a > b ? a : b;
+}
+
+/* Size of a hash table that starts with initial entries and doubles whenever it gets half full */
+long long GrownHashTableSize(long long initial, long long num_vertices)
+{
+	long long size = initial;
+	while (num_vertices * 2 > size) size *= 2;
+	return size;
+}
+
+/* Capacity of the vertex array once num_vertices have been added, growing by VERTEX_GROWTH whenever
+   fewer than two records are left, as AddVertex does */
+long long GrownVertexCapacity(long long num_vertices)
+{
+	long long capacity = initial_vertex_capacity;
+	while (num_vertices + 2 >= capacity) capacity *= VERTEX_GROWTH;
+	return capacity;
+}
+
+static void ComputeLINEMemory(LineMemoryPlan *plan)
+{
+	long long V = plan->num_vertices, E = plan->num_edges, dim = plan->dim;
+	long long hash_size = GrownHashTableSize(plan->hash_table_size, V);
+	long long hash_bytes = hash_size * plan->id_bytes + (hash_size > plan->hash_table_size ? hash_size / 2 * plan->id_bytes : 0);
+	// Several threads intern the names into a sharded dictionary instead of the hash table
+	if (plan->num_threads > 1) hash_bytes = InternerBytes(V);
+	long long vertex_bytes = GrownVertexCapacity(V) * (sizeof(double) + sizeof(char *));
+	// Names are rounded up to the arena alignment, half of it on average
+	long long name_bytes = (long long)(V * (plan->name_length + 1 + ARENA_ALIGNMENT / 2));
+	long long output_name_bytes = (long long)(V * (plan->name_length + 1));
+	long long weight_bytes = E * sizeof(double);
+	long long edge_bytes = E * 2 * plan->id_bytes + weight_bytes;
+	long long alias_bytes = E * (plan->alias_bytes + sizeof(double));
+	long long alias_scratch_bytes = E * (sizeof(double) + 2 * plan->alias_bytes);
+	long long emb_bytes = V * PaddedRowStride(dim) * sizeof(real);
+	long long neg_bytes = plan->neg_table_size * plan->id_bytes;
+	long long train_bytes = plan->num_threads * (dim * sizeof(real) + sizeof(pthread_t)) + (sigmoid_table_size + 1) * sizeof(real);
+	// Hub buffers: the hub slot of every vertex, and per thread a delta row, a dirty flag and a
+	// touched entry for every hub vertex row and hub context row
+	long long hub_slots = plan->hub_vertices * (plan->order == 2 ? 2 : 1);
+	if (plan->hub_vertices > 0)
+		train_bytes += V * sizeof(int) + plan->hub_vertices * sizeof(long long) +
+			plan->num_threads * hub_slots * (dim * sizeof(real) + sizeof(char) + sizeof(int));
+	long long output_bytes = V * (dim * sizeof(double) + sizeof(std::vector<double>) + sizeof(std::string)) + output_name_bytes;
+	long long matrix_bytes = V * dim * sizeof(double) + V * (R_STRING_OVERHEAD + sizeof(void *)) + output_name_bytes;
+	long long persistent;
+
+	// The hash table is released after reading, the last realloc of the vertices briefly holds the
+	// old array next to the grown one
+	plan->allocated[LINE_READ_DATA] = hash_bytes + vertex_bytes + name_bytes + edge_bytes;
+	plan->live[LINE_READ_DATA] = hash_bytes + vertex_bytes + vertex_bytes / VERTEX_GROWTH + name_bytes + edge_bytes;
+	persistent = vertex_bytes + name_bytes + edge_bytes;
+
+	// The edge weights are only needed to build the alias table
+	plan->allocated[LINE_ALIAS_TABLE] = alias_bytes + alias_scratch_bytes;
+	plan->live[LINE_ALIAS_TABLE] = persistent + alias_bytes + alias_scratch_bytes;
+	persistent += alias_bytes - weight_bytes;
+
+	// The context embedding is only used by the second order model
+	plan->allocated[LINE_INIT_VECTORS] = plan->order == 2 ? 2 * emb_bytes : emb_bytes;
+	plan->live[LINE_INIT_VECTORS] = persistent + plan->allocated[LINE_INIT_VECTORS];
+	persistent += plan->allocated[LINE_INIT_VECTORS];
+
+	plan->allocated[LINE_NEG_TABLE] = neg_bytes;
+	plan->live[LINE_NEG_TABLE] = persistent + neg_bytes;
+	persistent += neg_bytes;
+
+	plan->allocated[LINE_TRAIN] = train_bytes;
+	plan->live[LINE_TRAIN] = persistent + train_bytes;
+
+	// Everything but the vertex embedding is released before it is copied out, and the copy is
+	// released after the caller has copied it into the R matrix
+	plan->allocated[LINE_OUTPUT] = output_bytes + matrix_bytes;
+	plan->live[LINE_OUTPUT] = Max(vertex_bytes + name_bytes + emb_bytes + output_bytes, output_bytes + matrix_bytes);
+
+	plan->peak = 0;
+	for (int p = 0; p != LINE_NUM_PHASES; p++) plan->peak = Max(plan->peak, plan->live[p]);
+}
+
+/* Plan the memory of a line run with id_bytes wide vertex ids and alias_bytes wide edge ids; num_vertices may be
+   an upper bound. Returns 1 if the plan fits in the budget */
+int PlanLINEMemory(LineMemoryPlan *plan, long long num_edges, long long num_vertices, double name_length, int dim, int order,
+				int num_threads, long long budget, int id_bytes, int alias_bytes, long long hub_vertices)
+{
+	plan->num_edges = num_edges;
+	plan->num_vertices = num_vertices;
+	plan->name_length = name_length;
+	plan->dim = dim;
+	plan->order = order;
+	plan->num_threads = num_threads;
+	plan->hub_vertices = hub_vertices < num_vertices ? hub_vertices : num_vertices;
+	plan->budget = budget;
+	plan->id_bytes = id_bytes;
+	plan->alias_bytes = alias_bytes;
+	plan->hash_table_size = default_hash_table_size;
+	plan->neg_table_size = default_neg_table_size;
+	ComputeLINEMemory(plan);
+	last_plan = *plan;
+	if (budget <= 0 || plan->peak <= budget) return 1;
+
+	long long fitted_hash_table_size = GrownHashTableSize(1024, num_vertices);
+	if (fitted_hash_table_size < plan->hash_table_size)
+	{
+		plan->hash_table_size = fitted_hash_table_size;
+		ComputeLINEMemory(plan);
+	}
+
+	long long min_size = Max(min_neg_table_size, 10 * num_vertices);
+	while (plan->peak > budget && plan->neg_table_size / 2 >= min_size)
+	{
+		plan->neg_table_size /= 2;
+		ComputeLINEMemory(plan);
+	}
+	last_plan = *plan;
+	return plan->peak <= budget;
+}
+
+void PrintLINEMemoryPlan(const LineMemoryPlan *plan)
+{
+	Rprintf("Memory plan for %lld edges, %lld vertices, dimension %d: hash table %lld, negative table %lld entries\n",
+		plan->num_edges, plan->num_vertices, plan->dim, plan->hash_table_size, plan->neg_table_size);
+	Rprintf("%-24s %14s %14s\n", "phase", "allocated_mb", "live_mb");
+	for (int p = 0; p != LINE_NUM_PHASES; p++)
+		Rprintf("%-24s %14.1f %14.1f\n", line_memory_phase_names[p], plan->allocated[p] / 1048576.0, plan->live[p] / 1048576.0);
+	Rprintf("%-24s %14s %14.1f (budget %.1f)\n", "peak", "", plan->peak / 1048576.0, plan->budget / 1048576.0);
+}
+
+const LineMemoryPlan &LastLINEMemoryPlan()
+{
+	return last_plan;
+}
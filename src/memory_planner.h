@@ -0,0 +1,36 @@
+#ifndef MEMORY_PLANNER_H
+#define MEMORY_PLANNER_H
+
+static const long long default_hash_table_size = 30000000;
+static const long long default_neg_table_size = 1e8;
+static const long long min_neg_table_size = 1000000;
+static const long long initial_vertex_capacity = 1000;
+
+// Factor by which the vertex array grows when it is full
+#define VERTEX_GROWTH 2
+
+// Phases of TrainLINEMain, in the order they run
+enum LineMemoryPhase { LINE_READ_DATA = 0, LINE_ALIAS_TABLE, LINE_INIT_VECTORS, LINE_NEG_TABLE, LINE_TRAIN, LINE_OUTPUT, LINE_NUM_PHASES };
+
+extern const char *line_memory_phase_names[LINE_NUM_PHASES];
+
+struct LineMemoryPlan {
+	long long num_edges, num_vertices;
+	int dim, order, num_threads;
+	long long hub_vertices;                // vertices whose updates are buffered per thread
+	double name_length;                    // average vertex name length in bytes, without the terminator
+	// Representations
+	long long hash_table_size, neg_table_size;
+	int id_bytes, alias_bytes;
+	// Bytes allocated by each phase and bytes live at the peak of each phase
+	long long allocated[LINE_NUM_PHASES], live[LINE_NUM_PHASES];
+	long long peak, budget;
+};
+
+long long GrownHashTableSize(long long initial, long long num_vertices);
+long long GrownVertexCapacity(long long num_vertices);
+int PlanLINEMemory(LineMemoryPlan *plan, long long num_edges, long long num_vertices, double name_length, int dim, int order,
+				int num_threads, long long budget, int id_bytes, int alias_bytes, long long hub_vertices = 0);
+void PrintLINEMemoryPlan(const LineMemoryPlan *plan);
+const LineMemoryPlan &LastLINEMemoryPlan();
+#endif
@@ -0,0 +1,64 @@
+/*
+Row normalization of an embedding matrix, the last step of the LINE pipeline.
+
+Works on a column-major matrix in R's memory and writes into a single output, which may be the
+input itself. By default the arithmetic is double precision. With line_precision the entries are
+rounded to float, their float squares are summed in double as LINE's concatenate sums them, and
+the quotients are rounded to float again. The squares are not summed in float, so this follows
+LINE's float arithmetic without claiming to reproduce every program of LINE bit for bit.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "perf_counters.h"
+#include "trace.h"
+#include "simd.h"
+#include "parallel.h"
+
+// Rows normalized together; the block of every column is still in cache when it is divided
+#define ROW_BLOCK 512
+
+static int line_precision = 0;
+static long long num_rows = 0, vector_dim = 0;
+static const double *vec;
+static double *output;
+
+static void NormalizeTask(long long begin, long long end, void *arg)
+{
+	double len[ROW_BLOCK];
+	for (long long b = begin; b < end; b += ROW_BLOCK)
+	{
+		long long e = b + ROW_BLOCK < end ? b + ROW_BLOCK : end, n = e - b;
+		for (long long r = 0; r != n; r++) len[r] = 0;
+		for (long long c = 0; c != vector_dim; c++)
+		{
+			if (line_precision) SimdSquareAddFloat(len, vec + c * num_rows + b, n);
+			else SimdSquareAdd(len, vec + c * num_rows + b, n);
+		}
+		SimdSqrt(len, n);
+		for (long long c = 0; c != vector_dim; c++)
+		{
+			if (line_precision) SimdDivideFloat(output + c * num_rows + b, vec + c * num_rows + b, len, n);
+			else SimdDivide(output + c * num_rows + b, vec + c * num_rows + b, len, n);
+		}
+	}
+}
+
+/* Divide every row of a column-major rows x dim matrix by its length; output may be input_features */
+void NormalizeMain(const double *input_features, long long rows, long long dim, double *output_features, int line_precision_param, int num_threads)
+{
+	TRACE_SCOPE("NormalizeMain");
+	PerfReset();
+	line_precision = line_precision_param;
+	num_rows = rows;
+	vector_dim = dim;
+	vec = input_features;
+	output = output_features;
+
+	PerfCounters pc;
+	PerfStart(&pc, "normalize");
+	ParallelFor(num_rows, ROW_BLOCK, num_threads, NormalizeTask, NULL);
+	PerfStop(&pc);
+	PerfPrint();
+}
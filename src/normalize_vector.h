@@ -0,0 +1,6 @@
+#ifndef NORMALIZE_H
+#define NORMALIZE_H
+
+void NormalizeMain(const double *input_features, long long rows, long long dim, double *output_features, int line_precision = 0, int num_threads = 1);
+#endif
+
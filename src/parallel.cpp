@@ -0,0 +1,48 @@
+/*
+Minimal pthread parallel for, used by the native kernels that work directly on R memory.
+*/
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "parallel.h"
+
+struct ParallelRange {
+	long long begin, end;
+	ParallelTask task;
+	void *arg;
+};
+
+static void *ParallelThread(void *range)
+{
+	ParallelRange *r = (ParallelRange *)range;
+	r->task(r->begin, r->end, r->arg);
+	return NULL;
+}
+
+void ParallelFor(long long n, long long grain, int num_threads, ParallelTask task, void *arg)
+{
+	if (n <= 0) return;
+	if (grain < 1) grain = 1;
+	long long blocks = (n + grain - 1) / grain;
+	if (num_threads > blocks) num_threads = (int)blocks;
+	if (num_threads <= 1)
+	{
+		task(0, n, arg);
+		return;
+	}
+
+	ParallelRange *ranges = (ParallelRange *)malloc(num_threads * sizeof(ParallelRange));
+	pthread_t *pt = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+	for (int a = 0; a < num_threads; a++)
+	{
+		ranges[a].begin = blocks * a / num_threads * grain;
+		ranges[a].end = a == num_threads - 1 ? n : blocks * (a + 1) / num_threads * grain;
+		ranges[a].task = task;
+		ranges[a].arg = arg;
+	}
+	for (int a = 1; a < num_threads; a++) pthread_create(&pt[a], NULL, ParallelThread, &ranges[a]);
+	task(ranges[0].begin, ranges[0].end, arg);
+	for (int a = 1; a < num_threads; a++) pthread_join(pt[a], NULL);
+	free(pt);
+	free(ranges);
+}
@@ -0,0 +1,9 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+typedef void (*ParallelTask)(long long begin, long long end, void *arg);
+
+// Split [0, n) into one contiguous range per thread, each a multiple of grain except the last,
+// and run task on every range. A single range runs on the calling thread.
+void ParallelFor(long long n, long long grain, int num_threads, ParallelTask task, void *arg);
+#endif
@@ -0,0 +1,229 @@
+/*
+Hardware performance counters around the native phases.
+
+Each PerfStart/PerfStop pair opens one perf_event counter per event for the calling thread.
+Phase counters are opened with inherit set so that they also count the worker threads the
+phase starts, thread counters only count the thread that opened them. Counters that cannot
+be opened (no kernel support, perf_event_paranoid, virtual machines without a PMU or a
+platform other than Linux) are reported as unavailable instead of failing the run.
+Phases are also recorded on the trace timeline when a trace is being written, and their
+timing and peak resident set size are recorded even when the counters are disabled.
+The peak is the high-water mark of the process at the end of a phase. Only while the counters
+are enabled is the mark cleared, at the start of every outermost phase, so that it is the peak
+of that phase alone; phases nested in another phase only read it.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <vector>
+#include <string>
+#include <R.h>
+#include "perf_counters.h"
+#include "trace.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+static const char *event_names[PERF_NUM_EVENTS] = { "cycles", "instructions", "cache_misses", "dtlb_misses", "branch_misses" };
+
+static int perf_enabled = 0, perf_warned = 0, phase_depth = 0;  // phases are only started by the main thread
+static std::vector<PerfRecord> perf_records;
+static pthread_mutex_t perf_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static double NowSeconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Let the peak resident set size start again from the current resident set size */
+static void ResetPeakRSS()
+{
+#ifdef __linux__
+	FILE *fo = fopen("/proc/self/clear_refs", "w");
+	if (fo == NULL) return;
+	fputs("5", fo);
+	fclose(fo);
+#endif
+}
+
+static long long ReadPeakRSS()
+{
+#ifdef __linux__
+	char line[256];
+	long long kb = -1;
+	FILE *fi = fopen("/proc/self/status", "r");
+	if (fi != NULL)
+	{
+		while (fgets(line, sizeof(line), fi))
+			if (sscanf(line, "VmHWM: %lld kB", &kb) == 1) break;
+		fclose(fi);
+	}
+	if (kb >= 0) return kb * 1024;
+#endif
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef __APPLE__
+	return (long long)usage.ru_maxrss;
+#else
+	return (long long)usage.ru_maxrss * 1024;
+#endif
+}
+
+#ifdef __linux__
+static int OpenCounter(int event, int inherit)
+{
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	switch (event)
+	{
+	case PERF_CYCLES: attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+	case PERF_INSTRUCTIONS: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+	case PERF_CACHE_MISSES: attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+	case PERF_BRANCH_MISSES: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+	case PERF_DTLB_MISSES:
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		break;
+	}
+	attr.disabled = 1;
+	attr.inherit = inherit;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/* Read a counter, scaling it up when the kernel had to multiplex it with other events */
+static long long ReadCounter(int fd)
+{
+	unsigned long long data[3];
+	if (read(fd, data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0) return -1;
+	if (data[2] < data[1]) return (long long)((double)data[0] * data[1] / data[2]);
+	return (long long)data[0];
+}
+#endif
+
+void PerfEnable(int enable)
+{
+	perf_enabled = enable;
+	perf_warned = 0;
+}
+
+int PerfEnabled()
+{
+	return perf_enabled;
+}
+
+void PerfReset()
+{
+	pthread_mutex_lock(&perf_mutex);
+	perf_records.clear();
+	phase_depth = 0;
+	pthread_mutex_unlock(&perf_mutex);
+}
+
+void PerfStart(PerfCounters *pc, const char *phase, int thread)
+{
+	pc->phase = phase;
+	pc->thread = thread;
+	pc->trace_start = TraceEnabled() ? TraceNow() : -1;
+	for (int e = 0; e != PERF_NUM_EVENTS; e++) pc->fd[e] = -1;
+	if (thread < 0 && phase_depth++ == 0 && perf_enabled) ResetPeakRSS();
+	pc->start = NowSeconds();
+	if (!perf_enabled) return;
+#ifdef __linux__
+	for (int e = 0; e != PERF_NUM_EVENTS; e++)
+	{
+		pc->fd[e] = OpenCounter(e, thread < 0);
+		if (pc->fd[e] != -1)
+		{
+			ioctl(pc->fd[e], PERF_EVENT_IOC_RESET, 0);
+			ioctl(pc->fd[e], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+}
+
+void PerfStop(PerfCounters *pc)
+{
+	if (pc->trace_start >= 0) TraceEvent(pc->phase, pc->trace_start, TraceNow());
+	PerfRecord record;
+	record.seconds = NowSeconds() - pc->start;
+	record.phase = pc->phase;
+	record.thread = pc->thread;
+	record.peak_rss = -1;
+	if (pc->thread < 0)
+	{
+		record.peak_rss = ReadPeakRSS();
+		phase_depth--;
+	}
+	for (int e = 0; e != PERF_NUM_EVENTS; e++)
+	{
+		record.values[e] = -1;
+#ifdef __linux__
+		if (pc->fd[e] == -1) continue;
+		ioctl(pc->fd[e], PERF_EVENT_IOC_DISABLE, 0);
+		record.values[e] = ReadCounter(pc->fd[e]);
+		close(pc->fd[e]);
+		pc->fd[e] = -1;
+#endif
+	}
+	pthread_mutex_lock(&perf_mutex);
+	perf_records.push_back(record);
+	pthread_mutex_unlock(&perf_mutex);
+}
+
+/* Print the records of the last call; only call this from the main R thread */
+void PerfPrint()
+{
+	if (!perf_enabled) return;
+	int available = 0;
+	for (size_t r = 0; r != perf_records.size(); r++)
+		for (int e = 0; e != PERF_NUM_EVENTS; e++) if (perf_records[r].values[e] != -1) available = 1;
+	if (!available && !perf_warned)
+	{
+		Rprintf("Performance counters are not available on this system (check /proc/sys/kernel/perf_event_paranoid), only timings are reported\n");
+		perf_warned = 1;
+	}
+	Rprintf("%-24s %6s %10s %12s", "phase", "thread", "seconds", "peak_rss_mb");
+	for (int e = 0; e != PERF_NUM_EVENTS; e++) Rprintf(" %14s", event_names[e]);
+	Rprintf("\n");
+	for (size_t r = 0; r != perf_records.size(); r++)
+	{
+		const PerfRecord &record = perf_records[r];
+		Rprintf("%-24s %6d %10.4f", record.phase.c_str(), record.thread, record.seconds);
+		if (record.peak_rss == -1) Rprintf(" %12s", "NA");
+		else Rprintf(" %12.1f", record.peak_rss / 1048576.0);
+		for (int e = 0; e != PERF_NUM_EVENTS; e++)
+		{
+			if (record.values[e] == -1) Rprintf(" %14s", "NA");
+			else Rprintf(" %14lld", record.values[e]);
+		}
+		Rprintf("\n");
+	}
+}
+
+const std::vector<PerfRecord> &PerfReport()
+{
+	return perf_records;
+}
+
+/* Peak resident set size of the last record of a phase, -1 if the phase did not run */
+long long PerfPeakRSS(const char *phase)
+{
+	for (size_t r = perf_records.size(); r-- != 0;)
+		if (perf_records[r].thread < 0 && perf_records[r].phase == phase) return perf_records[r].peak_rss;
+	return -1;
+}
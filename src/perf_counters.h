@@ -0,0 +1,35 @@
+#include <vector>
+#include <string>
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#define PERF_NUM_EVENTS 5
+
+// Order of the values in PerfRecord::values
+enum PerfEvent { PERF_CYCLES = 0, PERF_INSTRUCTIONS, PERF_CACHE_MISSES, PERF_DTLB_MISSES, PERF_BRANCH_MISSES };
+
+struct PerfRecord {
+	std::string phase;
+	int thread;                            // -1 for a whole phase, including the threads it started
+	double seconds;
+	long long values[PERF_NUM_EVENTS];     // -1 when the counter is not available
+	long long peak_rss;                    // bytes, -1 when not available or for a thread
+};
+
+struct PerfCounters {
+	int fd[PERF_NUM_EVENTS];
+	double start, trace_start;
+	const char *phase;
+	int thread;
+};
+
+void PerfEnable(int enable);
+int PerfEnabled();
+void PerfReset();
+void PerfStart(PerfCounters *pc, const char *phase, int thread = -1);
+void PerfStop(PerfCounters *pc);
+void PerfPrint();
+const std::vector<PerfRecord> &PerfReport();
+long long PerfPeakRSS(const char *phase);
+#endif
@@ -0,0 +1,237 @@
+/*
+Joint training of the relations of a heterogeneous graph in one pass, as PTE does.
+
+Every relation, such as user-item or item-tag, keeps its own edge alias table and its own
+negative sampling table over the degrees within the relation, while all relations share one
+vertex table and one embedding. A training sample first draws a relation from an alias table
+of the relation weights, then an edge of that relation, and is trained with line's negative
+sampling and update, so one training loop learns what one line run per relation would.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <R.h>
+#include "line_kernel.h"
+#include "sampling.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "parallel.h"
+#include "memory_planner.h"
+#include "pte.h"
+
+static int order = 2, dim = 100, num_negative = 5, num_threads = 1, num_relations = 0;
+static long long num_vertices = 0, total_samples = 0;
+static real init_rho = 0.025;
+static real *emb_vertex, *emb_context, *sigmoid_table;
+static long long *edge_offset, *neg_offset, *neg_size;   // per relation: its edges and its negative table
+static int *edge_source_id, *edge_target_id, *alias, *neg_table, *relation_alias;
+static double *prob, *relation_prob, *degree;
+static unsigned long long *thread_seeds;
+
+static void FreePTE()
+{
+	free(emb_vertex); emb_vertex = NULL;
+	free(emb_context); emb_context = NULL;
+	free(sigmoid_table); sigmoid_table = NULL;
+	free(edge_offset); edge_offset = NULL;
+	free(neg_offset); neg_offset = NULL;
+	free(neg_size); neg_size = NULL;
+	free(edge_source_id); edge_source_id = NULL;
+	free(edge_target_id); edge_target_id = NULL;
+	free(alias); alias = NULL;
+	free(neg_table); neg_table = NULL;
+	free(relation_alias); relation_alias = NULL;
+	free(prob); prob = NULL;
+	free(relation_prob); relation_prob = NULL;
+	free(degree); degree = NULL;
+	free(thread_seeds); thread_seeds = NULL;
+}
+
+static double RelationDegree(long long k)
+{
+	return degree[k];
+}
+
+static void TrainPTEThread(long long begin, long long end, void *arg)
+{
+	real *vec_error = (real *)calloc(dim, sizeof(real));
+	for (long long id = begin; id != end; id++)
+	{
+		unsigned long long seed = thread_seeds[id];
+		long long samples = total_samples / num_threads;
+		real rho = init_rho;
+		PerfCounters pc;
+		PerfStart(&pc, "pte train thread", (int)id);
+		TraceThreadName("pte train thread");
+
+		for (long long count = 0; count != samples; count++)
+		{
+			if (count % 10000 == 0)
+			{
+				rho = init_rho * (1 - count / (real)(samples + 1));
+				if (rho < init_rho * 0.0001) rho = init_rho * 0.0001;
+			}
+
+			long long r = SampleAlias(relation_prob, relation_alias, num_relations, FastUniform(seed), FastUniform(seed));
+			long long first = edge_offset[r];
+			long long curedge = first + SampleAlias(prob + first, alias + first, edge_offset[r + 1] - first, FastUniform(seed), FastUniform(seed));
+			long long u = edge_source_id[curedge], v = edge_target_id[curedge];
+			real *vec_u = &emb_vertex[u * dim];
+			for (int c = 0; c != dim; c++) vec_error[c] = 0;
+
+			for (int d = 0; d != num_negative + 1; d++)
+			{
+				long long target = d == 0 ? v : neg_table[neg_offset[r] + FastRand(seed, neg_size[r])];
+				real *vec_v = order == 1 ? &emb_vertex[target * dim] : &emb_context[target * dim];
+				Update(vec_u, vec_v, vec_error, d == 0, dim, rho, sigmoid_table);
+			}
+			for (int c = 0; c != dim; c++) vec_u[c] += vec_error[c];
+		}
+		PerfStop(&pc);
+	}
+	free(vec_error);
+}
+
+/* Train a num_vertices x dim embedding on 0-based edges, each of one of num_relations relations.
+   Relations are sampled by relation_weight, or by their total edge weight when it is NULL.
+   Writes the column-major embedding to output_vectors; returns 0 if out of memory. */
+int TrainPTEMain(const int *source, const int *target, const double *weight, const int *relation, long long num_edges,
+                 long long num_vertices_param, int num_relations_param, const double *relation_weight, int dim_param, int order_param,
+                 int num_negative_param, double samples_param, float init_rho_param, int num_threads_param, double *output_vectors)
+{
+	TRACE_SCOPE("TrainPTEMain");
+	PerfReset();
+	num_vertices = num_vertices_param;
+	num_relations = num_relations_param;
+	dim = dim_param;
+	order = order_param;
+	num_negative = num_negative_param;
+	total_samples = (long long)(samples_param * 1000000);
+	init_rho = init_rho_param;
+	num_threads = num_threads_param < 1 ? 1 : num_threads_param;
+
+	std::vector<long long> relation_vertices(num_relations, 0);
+	std::vector<double> total_weight(num_relations, 0);
+	edge_offset = (long long *)calloc(num_relations + 1, sizeof(long long));
+	neg_offset = (long long *)calloc(num_relations + 1, sizeof(long long));
+	neg_size = (long long *)calloc(num_relations + 1, sizeof(long long));
+	if (edge_offset == NULL || neg_offset == NULL || neg_size == NULL)
+	{
+		Rprintf("Error: memory allocation failed\n");
+		FreePTE();
+		return 0;
+	}
+	for (long long e = 0; e != num_edges; e++)
+	{
+		edge_offset[relation[e] + 1]++;
+		total_weight[relation[e]] += weight[e];
+	}
+	for (int r = 0; r != num_relations; r++) edge_offset[r + 1] += edge_offset[r];
+	edge_source_id = (int *)malloc(num_edges * sizeof(int) + 1);
+	edge_target_id = (int *)malloc(num_edges * sizeof(int) + 1);
+	prob = (double *)malloc(num_edges * sizeof(double) + 1);
+	alias = (int *)malloc(num_edges * sizeof(int) + 1);
+	relation_prob = (double *)malloc(num_relations * sizeof(double) + 1);
+	relation_alias = (int *)malloc(num_relations * sizeof(int) + 1);
+	degree = (double *)malloc(num_vertices * sizeof(double) + 1);
+	emb_vertex = (real *)malloc(num_vertices * dim * sizeof(real) + 1);
+	if (order == 2) emb_context = (real *)malloc(num_vertices * dim * sizeof(real) + 1);
+	sigmoid_table = (real *)malloc((sigmoid_table_size + 1) * sizeof(real));
+	thread_seeds = (unsigned long long *)malloc(num_threads * sizeof(unsigned long long));
+	if (edge_source_id == NULL || edge_target_id == NULL || prob == NULL || alias == NULL || relation_prob == NULL ||
+	    relation_alias == NULL || degree == NULL || emb_vertex == NULL || (order == 2 && emb_context == NULL) ||
+	    sigmoid_table == NULL || thread_seeds == NULL)
+	{
+		Rprintf("Error: memory allocation failed\n");
+		FreePTE();
+		return 0;
+	}
+
+	PerfCounters pc;
+	PerfStart(&pc, "pte setup");
+	{
+		std::vector<long long> next(edge_offset, edge_offset + num_relations);
+		for (long long e = 0; e != num_edges; e++)
+		{
+			long long k = next[relation[e]]++;
+			edge_source_id[k] = source[e];
+			edge_target_id[k] = target[e];
+			prob[k] = weight[e];
+		}
+		std::vector<int> last_relation(num_vertices, -1);
+		for (int r = 0; r != num_relations; r++)
+			for (long long k = edge_offset[r]; k != edge_offset[r + 1]; k++)
+			{
+				int ends[2] = { edge_source_id[k], edge_target_id[k] };
+				for (int i = 0; i != 2; i++)
+					if (last_relation[ends[i]] != r)
+					{
+						last_relation[ends[i]] = r;
+						relation_vertices[r]++;
+					}
+			}
+	}
+	// Every relation gets a negative table of 100 entries per vertex it has, within an equal share
+	// of line's default table size
+	for (int r = 0; r != num_relations; r++)
+	{
+		long long size = 100 * relation_vertices[r], share = default_neg_table_size / num_relations;
+		if (size > share) size = share;
+		if (size < min_neg_table_size) size = min_neg_table_size;
+		neg_size[r] = size;
+		neg_offset[r + 1] = neg_offset[r] + size;
+	}
+	neg_table = (int *)malloc(neg_offset[num_relations] * sizeof(int) + 1);
+	int failed = neg_table == NULL;
+	for (int r = 0; !failed && r != num_relations; r++)
+	{
+		long long first = edge_offset[r], n = edge_offset[r + 1] - first;
+		std::vector<double> edge_weight(prob + first, prob + first + n);
+		if (n > 0 && !FillAliasTable(&edge_weight[0], n, alias + first, prob + first)) failed = 1;
+		for (long long k = 0; k != num_vertices; k++) degree[k] = 0;
+		for (long long e = first; e != first + n; e++)
+		{
+			degree[edge_source_id[e]] += edge_weight[e - first];
+			degree[edge_target_id[e]] += edge_weight[e - first];
+		}
+		FillNegTable(neg_table + neg_offset[r], neg_size[r], num_vertices, RelationDegree);
+	}
+	// Relations without edges cannot be sampled
+	std::vector<double> sampled_weight(num_relations);
+	for (int r = 0; r != num_relations; r++)
+		sampled_weight[r] = edge_offset[r + 1] == edge_offset[r] ? 0 : relation_weight != NULL ? relation_weight[r] : total_weight[r];
+	if (failed || (num_relations > 0 && !FillAliasTable(&sampled_weight[0], num_relations, relation_alias, relation_prob)))
+	{
+		PerfStop(&pc);
+		Rprintf("Error: memory allocation failed\n");
+		FreePTE();
+		return 0;
+	}
+
+	GetRNGstate();
+	for (long long k = 0; k != num_vertices; k++)
+		for (int c = 0; c != dim; c++)
+		{
+			emb_vertex[k * dim + c] = (unif_rand() - 0.5) / dim;
+			if (order == 2) emb_context[k * dim + c] = 0;
+		}
+	for (int a = 0; a != num_threads; a++) thread_seeds[a] = (unsigned long long)(unif_rand() * 4294967296.0) + a;
+	PutRNGstate();
+	InitSigmoidTable(sigmoid_table);
+	PerfStop(&pc);
+
+	if (num_edges > 0)
+	{
+		PerfStart(&pc, "pte train");
+		ParallelFor(num_threads, 1, num_threads, TrainPTEThread, NULL);
+		PerfStop(&pc);
+	}
+	PerfPrint();
+
+	for (long long k = 0; k != num_vertices; k++)
+		for (int c = 0; c != dim; c++) output_vectors[c * num_vertices + k] = emb_vertex[k * dim + c];
+	FreePTE();
+	return 1;
+}
@@ -0,0 +1,7 @@
+#ifndef PTE_H
+#define PTE_H
+
+int TrainPTEMain(const int *source, const int *target, const double *weight, const int *relation, long long num_edges,
+                 long long num_vertices, int num_relations, const double *relation_weight, int dim_param, int order_param,
+                 int num_negative_param, double samples_param, float init_rho_param, int num_threads_param, double *output_vectors);
+#endif
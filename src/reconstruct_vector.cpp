@@ -7,6 +7,14 @@
 #include <map>
 #include <queue>
 #include <string> 
+#include <R.h>
+#include "perf_counters.h"
+#include "trace.h"
+#include "arena.h"
+#include "memory_planner.h"
+#include "compressed_graph.h"
+#include "edge_file.h"
+#include "arrow_data.h"
 
 #define MAX_STRING 100
 
@@ -34,18 +42,20 @@ struct Neighbor
 static char train_file[MAX_STRING], output_file[MAX_STRING];
 static struct ClassVertex *vertex;
 static int *vertex_hash_table;
-static int max_num_vertices = 1000, num_vertices = 0;
+static int max_num_vertices = initial_vertex_capacity, num_vertices = 0;
+static int malloc_exit = 0;
+static Arena arena = ARENA_INIT;      // vertex names and per-call scratch, released at the end of a call
 static long long num_edges = 0;
 
 static int max_depth = 1, max_k = 0;
 std::vector<int> vertex_set;
-std::vector<Neighbor> *neighbor;
+std::vector<Neighbor> *neighbor = NULL;
 
 static Neighbor *rank_list;
 std::map<int, double> vid2weight;
 
 /* Build a hash table, mapping each vertex name to a unique vertex id */
-static unsigned int Hash(char *key)
+static unsigned int Hash(const char *key)
 {
 	unsigned int seed = 131;
 	unsigned int hash = 0;
@@ -59,17 +69,18 @@ static unsigned int Hash(char *key)
 static void InitHashTable()
 {
 	vertex_hash_table = (int *)malloc(hash_table_size * sizeof(int));
+	if (vertex_hash_table == NULL) return;
 	for (int k = 0; k != hash_table_size; k++) vertex_hash_table[k] = -1;
 }
 
-static void InsertHashTable(char *key, int value)
+static void InsertHashTable(const char *key, int value)
 {
 	int addr = Hash(key);
 	while (vertex_hash_table[addr] != -1) addr = (addr + 1) % hash_table_size;
 	vertex_hash_table[addr] = value;
 }
 
-static int SearchHashTable(char *key)
+static int SearchHashTable(const char *key)
 {
 	int addr = Hash(key);
 	while (1)
@@ -81,24 +92,38 @@ static int SearchHashTable(char *key)
 	return -1;
 }
 
-/* Add a vertex to the vertex set */
-static int AddVertex(char *name)
+/* Add a vertex to the vertex set, with its whole name copied into the arena; returns -1 if out of memory */
+static int AddVertex(const char *name)
 {
-	int length = strlen(name) + 1;
-	if (length > MAX_STRING) length = MAX_STRING;
-	vertex[num_vertices].name = (char *)calloc(length, sizeof(char));
-	strcpy(vertex[num_vertices].name, name);
+	vertex[num_vertices].name = ArenaStrdup(&arena, name);
+	if (vertex[num_vertices].name == NULL) return -1;
+	vertex[num_vertices].degree = 0;
 	vertex[num_vertices].sum_weight = 0;
 	num_vertices++;
 	if (num_vertices + 2 >= max_num_vertices)
 	{
-		max_num_vertices += 1000;
-		vertex = (struct ClassVertex *)realloc(vertex, max_num_vertices * sizeof(struct ClassVertex));
+		struct ClassVertex *grown = (struct ClassVertex *)realloc(vertex, VERTEX_GROWTH * (size_t)max_num_vertices * sizeof(struct ClassVertex));
+		if (grown == NULL) return -1;
+		vertex = grown;
+		max_num_vertices *= VERTEX_GROWTH;
 	}
 	InsertHashTable(name, num_vertices - 1);
 	return num_vertices - 1;
 }
 
+/* Release all state of a call */
+static void FreeReconstruct()
+{
+	free(vertex_hash_table); vertex_hash_table = NULL;
+	free(vertex); vertex = NULL;
+	delete[] neighbor; neighbor = NULL;
+	rank_list = NULL;
+	ArenaRelease(&arena);
+	vid2weight.clear();
+	num_vertices = 0;
+	max_num_vertices = initial_vertex_capacity;
+}
+
 /*
 static int ArgPos(char *str, int argc, char **argv) {
 	int a;
@@ -144,18 +169,16 @@ static int ArgPos(char *str, int argc, char **argv) {
 /* Read network from the training file */
 static void VectorReadData(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v, const std::vector<double> input_w)
 {
-	char name_v1[MAX_STRING], name_v2[MAX_STRING];
 	int vid, u, v;
 	double weight;
 	Neighbor nb;
 
-	num_edges = (int) input_u.size();
+	num_edges = (long long) input_u.size();
 	num_vertices = 0;
 
-	for (int k = 0; k != num_edges; k++)
+	for (long long k = 0; k != num_edges; k++)
 	{
-		strcpy(name_v1, input_u[k].c_str());
-		strcpy(name_v2, input_v[k].c_str());
+		const char *name_v1 = input_u[k].c_str(), *name_v2 = input_v[k].c_str();
 		weight = input_w[k];
 
 		/*if (k % 10000 == 0)
@@ -165,22 +188,22 @@ static void VectorReadData(const std::vector<std::string> &input_u, const std::v
 		}*/
 
 		vid = SearchHashTable(name_v1);
-		if (vid == -1) vid = AddVertex(name_v1);
+		if (vid == -1 && (vid = AddVertex(name_v1)) == -1) { malloc_exit = 1; return; }
 		vertex[vid].degree += weight;
 
 		vid = SearchHashTable(name_v2);
-		if (vid == -1) vid = AddVertex(name_v2);
+		if (vid == -1 && (vid = AddVertex(name_v2)) == -1) { malloc_exit = 1; return; }
 		vertex[vid].degree += weight;
 	}
 	//printf("Number of vertices: %d          \n", num_vertices);
 
 	neighbor = new std::vector<Neighbor>[num_vertices];
-	rank_list = (Neighbor *)calloc(num_vertices, sizeof(Neighbor));
+	rank_list = (Neighbor *)ArenaCalloc(&arena, num_vertices, sizeof(Neighbor));
+	if (rank_list == NULL) { malloc_exit = 1; return; }
 
 	for (long long k = 0; k != num_edges; k++)
 	{
-		strcpy(name_v1, input_u[k].c_str());
-		strcpy(name_v2, input_v[k].c_str());
+		const char *name_v1 = input_u[k].c_str(), *name_v2 = input_v[k].c_str();
 		weight = input_w[k];
 
 		/*if (k % 10000 == 0)
@@ -202,15 +225,100 @@ static void VectorReadData(const std::vector<std::string> &input_u, const std::v
 	for (int k = 0; k != num_vertices; k++)
 	{
 		vertex[k].sum_weight = 0;
-		int len = neighbor[k].size();
-		for (int i = 0; i != len; i++)
+		long long len = neighbor[k].size();
+		for (long long i = 0; i != len; i++)
 			vertex[k].sum_weight += neighbor[k][i].weight;
 	}
 }
 
+/* Read the edges of a compressed graph straight from its arrays, with the names of the graph as the vertex names */
+static void VectorReadGraph(const CompressedGraph &graph)
+{
+	Neighbor nb;
+	long long *id = (long long *)malloc(graph.num_vertices * sizeof(long long) + 1);
+	if (id == NULL) { malloc_exit = 1; return; }
+
+	num_edges = graph.num_edges;
+	num_vertices = (int)CompactGraphVertices(graph, id);
+	vertex = (struct ClassVertex *)calloc(num_vertices + 1, sizeof(struct ClassVertex));
+	rank_list = (Neighbor *)ArenaCalloc(&arena, num_vertices, sizeof(Neighbor));
+	if (vertex == NULL || rank_list == NULL) { malloc_exit = 1; free(id); return; }
+	neighbor = new std::vector<Neighbor>[num_vertices];
+
+	for (long long k = 0; k != graph.num_vertices; k++) if (id[k] != -1) vertex[id[k]].name = (char *)graph.names[k];
+	for (long long j = 0; j != graph.num_vertices; j++)
+		for (long long e = graph.col_ptr[j]; e != graph.col_ptr[j + 1]; e++)
+		{
+			int u = (int)id[graph.row[e]];
+			nb.vid = (int)id[j];
+			nb.weight = graph.weight[e];
+			vertex[u].degree += nb.weight;
+			vertex[nb.vid].degree += nb.weight;
+			vertex[u].sum_weight += nb.weight;
+			neighbor[u].push_back(nb);
+		}
+	free(id);
+}
+
+/* Read the edges of a binary edge file straight from its records, with its name table as the vertex names */
+static void VectorReadEdges(const EdgeFile &edge_file)
+{
+	Neighbor nb;
+	num_edges = edge_file.num_edges;
+	num_vertices = (int)edge_file.num_vertices;
+	vertex = (struct ClassVertex *)calloc(num_vertices + 1, sizeof(struct ClassVertex));
+	rank_list = (Neighbor *)ArenaCalloc(&arena, num_vertices, sizeof(Neighbor));
+	if (vertex == NULL || rank_list == NULL) { malloc_exit = 1; return; }
+	neighbor = new std::vector<Neighbor>[num_vertices];
+
+	for (int k = 0; k != num_vertices; k++) vertex[k].name = (char *)edge_file.names[k];
+	for (long long e = 0; e != num_edges; e++)
+	{
+		const EdgeRecord &r = edge_file.edges[e];
+		nb.vid = r.target;
+		nb.weight = r.weight;
+		vertex[r.source].degree += nb.weight;
+		vertex[r.target].degree += nb.weight;
+		vertex[r.source].sum_weight += nb.weight;
+		neighbor[r.source].push_back(nb);
+	}
+}
+
+/* Read the edges of an Arrow record batch from its columns in place */
+static void VectorReadArrow(const ArrowEdges &arrow_edges)
+{
+	const long long chunk = 1024;
+	long long source[chunk], target[chunk];
+	double weight[chunk];
+	Neighbor nb;
+	num_edges = arrow_edges.num_edges;
+	num_vertices = (int)arrow_edges.num_vertices;
+	vertex = (struct ClassVertex *)calloc(num_vertices + 1, sizeof(struct ClassVertex));
+	rank_list = (Neighbor *)ArenaCalloc(&arena, num_vertices, sizeof(Neighbor));
+	if (vertex == NULL || rank_list == NULL) { malloc_exit = 1; return; }
+	neighbor = new std::vector<Neighbor>[num_vertices];
+
+	for (int k = 0; k != num_vertices; k++) vertex[k].name = (char *)arrow_edges.names[k];
+	for (long long begin = 0; begin < num_edges; begin += chunk)
+	{
+		long long end = begin + chunk < num_edges ? begin + chunk : num_edges;
+		ArrowEdgesRead(arrow_edges, begin, end, source, target, weight);
+		for (long long e = 0; e != end - begin; e++)
+		{
+			nb.vid = (int)target[e];
+			nb.weight = weight[e];
+			vertex[source[e]].degree += nb.weight;
+			vertex[nb.vid].degree += nb.weight;
+			vertex[source[e]].sum_weight += nb.weight;
+			neighbor[source[e]].push_back(nb);
+		}
+	}
+}
+
 static void VectorReconstruct(std::vector<std::string> &output_u, std::vector<std::string> &output_v, std::vector<double> &output_w)
 {
-	int sv, cv, cd, len, pst;
+	int sv, cv, cd;
+	long long len, pst;
 	long long num_edges_renet = 0;
 	double cw, sum;
 	std::queue<int> node, depth;
@@ -238,7 +346,7 @@ static void VectorReconstruct(std::vector<std::string> &output_u, std::vector<st
 		len = neighbor[sv].size();
 		if (len > max_k)
 		{
-			for (int i = 0; i != len; i++){
+			for (long long i = 0; i != len; i++){
 				output_u.push_back(std::string(vertex[sv].name));
 				output_v.push_back(std::string(vertex[neighbor[sv][i].vid].name));
 				output_w.push_back(neighbor[sv][i].weight);
@@ -273,7 +381,7 @@ static void VectorReconstruct(std::vector<std::string> &output_u, std::vector<st
 				len = neighbor[cv].size();
 				sum = vertex[cv].sum_weight;
 
-				for (int i = 0; i != len; i++)
+				for (long long i = 0; i != len; i++)
 				{
 					node.push(neighbor[cv][i].vid);
 					depth.push(cd + 1);
@@ -292,7 +400,7 @@ static void VectorReconstruct(std::vector<std::string> &output_u, std::vector<st
 		}
 		std::sort(rank_list, rank_list + pst);
 
-		for (int i = 0; i != max_k; i++)
+		for (long long i = 0; i != max_k; i++)
 		{
 			if (i == pst) break;
 			output_u.push_back(std::string(vertex[sv].name));
@@ -306,10 +414,12 @@ static void VectorReconstruct(std::vector<std::string> &output_u, std::vector<st
 	return;
 }
 
-void ReconstructMain(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v,
-           const std::vector<double> &input_w, std::vector<std::string> &output_u,
-           std::vector<std::string> &output_v, std::vector<double> &output_w, int maximum_depth = 1, int maximum_k = 0) {
-	vertex = (struct ClassVertex *)calloc(max_num_vertices, sizeof(struct ClassVertex));
+/* Reconstruct the edges of graph, edge_file or arrow_edges, or of input_u, input_v and input_w when all are NULL */
+static void Reconstruct(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v, const std::vector<double> &input_w,
+					const CompressedGraph *graph, const EdgeFile *edge_file, const ArrowEdges *arrow_edges,
+					std::vector<std::string> &output_u, std::vector<std::string> &output_v,
+					std::vector<double> &output_w, int maximum_depth, int maximum_k) {
+	PerfReset();
 	max_depth = maximum_depth;
 	max_k = maximum_k;
 	/*if (max_depth == 0) {
@@ -317,7 +427,62 @@ void ReconstructMain(const std::vector<std::string> &input_u, const std::vector<
 	  return;
 	}*/
     if (max_depth == 0) return;
-	InitHashTable();
-	VectorReadData(input_u, input_v, input_w);
+	PerfCounters pc;
+	PerfStart(&pc, "reconstruct read data");
+	malloc_exit = 0;
+	if (graph != NULL) VectorReadGraph(*graph);
+	else if (edge_file != NULL) VectorReadEdges(*edge_file);
+	else if (arrow_edges != NULL) VectorReadArrow(*arrow_edges);
+	else
+	{
+		vertex = (struct ClassVertex *)calloc(max_num_vertices, sizeof(struct ClassVertex));
+		InitHashTable();
+		if (vertex == NULL || vertex_hash_table == NULL) malloc_exit = 1;
+		else VectorReadData(input_u, input_v, input_w);
+	}
+	PerfStop(&pc);
+	if (malloc_exit)
+	{
+		Rprintf("Error: memory allocation failed!\n");
+		FreeReconstruct();
+		return;
+	}
+	// The names are only looked up while reading
+	free(vertex_hash_table); vertex_hash_table = NULL;
+	PerfStart(&pc, "reconstruct");
 	VectorReconstruct(output_u, output_v, output_w);
+	PerfStop(&pc);
+	PerfPrint();
+	FreeReconstruct();
+}
+
+void ReconstructMain(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v,
+           const std::vector<double> &input_w, std::vector<std::string> &output_u,
+           std::vector<std::string> &output_v, std::vector<double> &output_w, int maximum_depth = 1, int maximum_k = 0) {
+	TRACE_SCOPE("ReconstructMain");
+	Reconstruct(input_u, input_v, input_w, NULL, NULL, NULL, output_u, output_v, output_w, maximum_depth, maximum_k);
+}
+
+void ReconstructGraphMain(const CompressedGraph &graph, std::vector<std::string> &output_u, std::vector<std::string> &output_v,
+					std::vector<double> &output_w, int maximum_depth, int maximum_k) {
+	TRACE_SCOPE("ReconstructGraphMain");
+	std::vector<std::string> no_names;
+	std::vector<double> no_weights;
+	Reconstruct(no_names, no_names, no_weights, &graph, NULL, NULL, output_u, output_v, output_w, maximum_depth, maximum_k);
+}
+
+void ReconstructEdgeFileMain(const EdgeFile &edge_file, std::vector<std::string> &output_u, std::vector<std::string> &output_v,
+					std::vector<double> &output_w, int maximum_depth, int maximum_k) {
+	TRACE_SCOPE("ReconstructEdgeFileMain");
+	std::vector<std::string> no_names;
+	std::vector<double> no_weights;
+	Reconstruct(no_names, no_names, no_weights, NULL, &edge_file, NULL, output_u, output_v, output_w, maximum_depth, maximum_k);
+}
+
+void ReconstructArrowMain(const ArrowEdges &arrow_edges, std::vector<std::string> &output_u, std::vector<std::string> &output_v,
+					std::vector<double> &output_w, int maximum_depth, int maximum_k) {
+	TRACE_SCOPE("ReconstructArrowMain");
+	std::vector<std::string> no_names;
+	std::vector<double> no_weights;
+	Reconstruct(no_names, no_names, no_weights, NULL, NULL, &arrow_edges, output_u, output_v, output_w, maximum_depth, maximum_k);
 }
@@ -1,5 +1,8 @@
 #include <vector>
 #include <string>
+#include "compressed_graph.h"
+#include "edge_file.h"
+#include "arrow_data.h"
 
 #ifndef RECONSTRUCT_H
 #define RECONSTRUCT_H
@@ -7,6 +10,12 @@
 void ReconstructMain(const std::vector<std::string> &input_u, const std::vector<std::string> &input_v, 
 					const std::vector<double> &input_w, std::vector<std::string> &output_u, 
 					std::vector<std::string> &output_v, std::vector<double> &output_w, int max_depth = 1, int max_k = 0);
+void ReconstructGraphMain(const CompressedGraph &graph, std::vector<std::string> &output_u, std::vector<std::string> &output_v,
+					std::vector<double> &output_w, int max_depth = 1, int max_k = 0);
+void ReconstructArrowMain(const ArrowEdges &arrow_edges, std::vector<std::string> &output_u, std::vector<std::string> &output_v,
+					std::vector<double> &output_w, int max_depth = 1, int max_k = 0);
+void ReconstructEdgeFileMain(const EdgeFile &edge_file, std::vector<std::string> &output_u, std::vector<std::string> &output_v,
+					std::vector<double> &output_w, int max_depth = 1, int max_k = 0);
 
 
 #endif
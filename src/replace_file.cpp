@@ -0,0 +1,73 @@
+/*
+Files that replace their target in one step.
+
+Graphs and edge files are mapped by the processes that load them, so writing one in place would
+truncate a file that this or another R session may still have mapped, and the next read of the
+mapping would raise SIGBUS. The new file is written next to the target instead and renamed over
+it when it is complete: a mapping of the old file keeps the old contents, and the target is never
+seen half written, nor lost when the write fails.
+*/
+
+#include <stdio.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "replace_file.h"
+
+/* Create a temporary file next to file; returns NULL if it cannot be created */
+FILE *ReplaceFileOpen(ReplaceFile *replace, const char *file)
+{
+	replace->fo = NULL;
+	replace->file = file;
+	for (int attempt = 0; attempt != 100 && replace->fo == NULL; attempt++)
+	{
+		char suffix[64];
+#ifndef _WIN32
+		snprintf(suffix, sizeof(suffix), ".tmp%d.%d", (int)getpid(), attempt);
+		replace->temp_file = replace->file + suffix;
+		int fd = open(replace->temp_file.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+		if (fd < 0)
+		{
+			if (errno == EEXIST) continue;
+			break;
+		}
+		replace->fo = fdopen(fd, "wb");
+		if (replace->fo == NULL)
+		{
+			close(fd);
+			remove(replace->temp_file.c_str());
+			break;
+		}
+#else
+		snprintf(suffix, sizeof(suffix), ".tmp%d", attempt);
+		replace->temp_file = replace->file + suffix;
+		FILE *fi = fopen(replace->temp_file.c_str(), "rb");
+		if (fi != NULL)
+		{
+			fclose(fi);
+			continue;
+		}
+		replace->fo = fopen(replace->temp_file.c_str(), "wb");
+		if (replace->fo == NULL) break;
+#endif
+	}
+	return replace->fo;
+}
+
+/* Close the temporary file and rename it over the target if ok, or remove it otherwise; returns 1
+   if the target was replaced */
+int ReplaceFileClose(ReplaceFile *replace, int ok)
+{
+	if (replace->fo == NULL) return 0;
+	ok = fclose(replace->fo) == 0 && ok;
+	replace->fo = NULL;
+#ifdef _WIN32
+	// rename does not replace an existing file on Windows, where loaded files are read rather than mapped
+	if (ok) remove(replace->file.c_str());
+#endif
+	ok = ok && rename(replace->temp_file.c_str(), replace->file.c_str()) == 0;
+	if (!ok) remove(replace->temp_file.c_str());
+	return ok;
+}
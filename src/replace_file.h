@@ -0,0 +1,16 @@
+#include <stdio.h>
+#include <string>
+
+#ifndef REPLACE_FILE_H
+#define REPLACE_FILE_H
+
+// A file written under a temporary name in the directory of its target, which only replaces the
+// target once it is complete
+struct ReplaceFile {
+	FILE *fo;
+	std::string file, temp_file;
+};
+
+FILE *ReplaceFileOpen(ReplaceFile *replace, const char *file);
+int ReplaceFileClose(ReplaceFile *replace, int ok);
+#endif
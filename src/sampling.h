@@ -0,0 +1,102 @@
+#include <stdlib.h>
+#include <math.h>
+
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#define NEG_SAMPLING_POWER 0.75
+
+/* Fill the negative sampling table: every vertex k takes a share of the entries proportional to
+   degree(k)^NEG_SAMPLING_POWER, so a uniform entry is a vertex sampled by its smoothed degree */
+template <typename vid_t, typename Degree>
+inline void FillNegTable(vid_t *neg_table, long long neg_table_size, long long num_vertices, Degree degree)
+{
+	double sum = 0, cur_sum = 0, por = 0;
+	long long vid = 0;
+	for (long long k = 0; k != num_vertices; k++) sum += pow(degree(k), NEG_SAMPLING_POWER);
+	for (long long k = 0; k != neg_table_size; k++)
+	{
+		if ((double)(k + 1) / neg_table_size > por && vid != num_vertices)
+		{
+			cur_sum += pow(degree(vid), NEG_SAMPLING_POWER);
+			por = cur_sum / sum;
+			vid++;
+		}
+		neg_table[k] = (vid_t)(vid - 1);
+	}
+}
+
+/* The alias sampling algorithm, which is used to sample one of n weights in O(1) time. Returns 0
+   if the scratch memory cannot be allocated. */
+template <typename eid_t>
+inline int FillAliasTable(const double *weight, long long n, eid_t *alias, double *prob)
+{
+	double *norm_prob = (double*)malloc(n*sizeof(double));
+	eid_t *large_block = (eid_t*)malloc(n*sizeof(eid_t));
+	eid_t *small_block = (eid_t*)malloc(n*sizeof(eid_t));
+	if (norm_prob == NULL || large_block == NULL || small_block == NULL)
+	{
+		free(norm_prob);
+		free(large_block);
+		free(small_block);
+		return 0;
+	}
+
+	double sum = 0;
+	long long cur_small_block, cur_large_block;
+	long long num_small_block = 0, num_large_block = 0;
+
+	for (long long k = 0; k != n; k++) sum += weight[k];
+	for (long long k = 0; k != n; k++) norm_prob[k] = weight[k] * n / sum;
+
+	for (long long k = n - 1; k >= 0; k--)
+	{
+		if (norm_prob[k]<1)
+			small_block[num_small_block++] = k;
+		else
+			large_block[num_large_block++] = k;
+	}
+
+	while (num_small_block && num_large_block)
+	{
+		cur_small_block = small_block[--num_small_block];
+		cur_large_block = large_block[--num_large_block];
+		prob[cur_small_block] = norm_prob[cur_small_block];
+		alias[cur_small_block] = cur_large_block;
+		norm_prob[cur_large_block] = norm_prob[cur_large_block] + norm_prob[cur_small_block] - 1;
+		if (norm_prob[cur_large_block] < 1)
+			small_block[num_small_block++] = cur_large_block;
+		else
+			large_block[num_large_block++] = cur_large_block;
+	}
+
+	while (num_large_block) prob[large_block[--num_large_block]] = 1;
+	while (num_small_block) prob[small_block[--num_small_block]] = 1;
+
+	free(norm_prob);
+	free(small_block);
+	free(large_block);
+	return 1;
+}
+
+template <typename eid_t>
+inline long long SampleAlias(const double *prob, const eid_t *alias, long long n, double rand_value1, double rand_value2)
+{
+	long long k = (long long)n * rand_value1;
+	return rand_value2 < prob[k] ? k : alias[k];
+}
+
+/* Fastly generate a random integer in [0, n) */
+inline long long FastRand(unsigned long long &seed, long long n)
+{
+	seed = seed * 25214903917 + 11;
+	return (seed >> 16) % n;
+}
+
+/* Fastly generate a random double in [0, 1) from the same generator */
+inline double FastUniform(unsigned long long &seed)
+{
+	seed = seed * 25214903917 + 11;
+	return (seed >> 11) * (1.0 / 9007199254740992.0);
+}
+#endif
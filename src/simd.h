@@ -0,0 +1,161 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <math.h>
+
+// Vector loops over doubles. AVX is used when the compiler targets it, otherwise SSE2, which
+// every x86-64 compiler targets, and plain loops elsewhere. Loads and stores are unaligned
+// because R vectors are only guaranteed to be 8-byte aligned.
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SIMD_DOUBLES 4
+#define SIMD_NAME "avx"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SIMD_DOUBLES 2
+#define SIMD_NAME "sse2"
+#else
+#define SIMD_DOUBLES 1
+#define SIMD_NAME "scalar"
+#endif
+#define SIMD_FLOATS (SIMD_DOUBLES == 1 ? 1 : 2 * SIMD_DOUBLES)
+
+/* acc[i] += x[i] * x[i] */
+inline void SimdSquareAdd(double *acc, const double *x, long long n)
+{
+	long long i = 0;
+#if defined(__AVX__)
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d v = _mm256_loadu_pd(x + i);
+		_mm256_storeu_pd(acc + i, _mm256_add_pd(_mm256_loadu_pd(acc + i), _mm256_mul_pd(v, v)));
+	}
+#elif defined(__SSE2__)
+	for (; i + 2 <= n; i += 2)
+	{
+		__m128d v = _mm_loadu_pd(x + i);
+		_mm_storeu_pd(acc + i, _mm_add_pd(_mm_loadu_pd(acc + i), _mm_mul_pd(v, v)));
+	}
+#endif
+	for (; i < n; i++) acc[i] += x[i] * x[i];
+}
+
+/* out[i] = x[i] / len[i] */
+inline void SimdDivide(double *out, const double *x, const double *len, long long n)
+{
+	long long i = 0;
+#if defined(__AVX__)
+	for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(len + i)));
+#elif defined(__SSE2__)
+	for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_div_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(len + i)));
+#endif
+	for (; i < n; i++) out[i] = x[i] / len[i];
+}
+
+/* x[i] = sqrt(x[i]) */
+inline void SimdSqrt(double *x, long long n)
+{
+	long long i = 0;
+#if defined(__AVX__)
+	for (; i + 4 <= n; i += 4) _mm256_storeu_pd(x + i, _mm256_sqrt_pd(_mm256_loadu_pd(x + i)));
+#elif defined(__SSE2__)
+	for (; i + 2 <= n; i += 2) _mm_storeu_pd(x + i, _mm_sqrt_pd(_mm_loadu_pd(x + i)));
+#endif
+	for (; i < n; i++) x[i] = sqrt(x[i]);
+}
+/* acc[i] += x[i] * x[i] with x[i] rounded to float and the product taken in float, as LINE does */
+inline void SimdSquareAddFloat(double *acc, const double *x, long long n)
+{
+	long long i = 0;
+#if defined(__AVX__)
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 v = _mm256_cvtpd_ps(_mm256_loadu_pd(x + i));
+		_mm256_storeu_pd(acc + i, _mm256_add_pd(_mm256_loadu_pd(acc + i), _mm256_cvtps_pd(_mm_mul_ps(v, v))));
+	}
+#elif defined(__SSE2__)
+	for (; i + 2 <= n; i += 2)
+	{
+		__m128 v = _mm_cvtpd_ps(_mm_loadu_pd(x + i));
+		_mm_storeu_pd(acc + i, _mm_add_pd(_mm_loadu_pd(acc + i), _mm_cvtps_pd(_mm_mul_ps(v, v))));
+	}
+#endif
+	for (; i < n; i++)
+	{
+		float v = (float)x[i];
+		acc[i] += (double)(v * v);
+	}
+}
+
+/* out[i] = x[i] / len[i] with x[i] and the quotient rounded to float, as LINE does */
+inline void SimdDivideFloat(double *out, const double *x, const double *len, long long n)
+{
+	long long i = 0;
+#if defined(__AVX__)
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d v = _mm256_cvtps_pd(_mm256_cvtpd_ps(_mm256_loadu_pd(x + i)));
+		_mm256_storeu_pd(out + i, _mm256_cvtps_pd(_mm256_cvtpd_ps(_mm256_div_pd(v, _mm256_loadu_pd(len + i)))));
+	}
+#elif defined(__SSE2__)
+	for (; i + 2 <= n; i += 2)
+	{
+		__m128d v = _mm_cvtps_pd(_mm_cvtpd_ps(_mm_loadu_pd(x + i)));
+		_mm_storeu_pd(out + i, _mm_cvtps_pd(_mm_cvtpd_ps(_mm_div_pd(v, _mm_loadu_pd(len + i)))));
+	}
+#endif
+	for (; i < n; i++) out[i] = (double)(float)((double)(float)x[i] / len[i]);
+}
+
+/* Dot product of two double vectors */
+inline double SimdDot(const double *a, const double *b, long long n)
+{
+	long long i = 0;
+	double sum = 0;
+#if defined(__AVX__)
+	double lanes[4];
+	__m256d acc = _mm256_setzero_pd();
+	for (; i + 4 <= n; i += 4) acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+	_mm256_storeu_pd(lanes, acc);
+	for (int l = 0; l != 4; l++) sum += lanes[l];
+#elif defined(__SSE2__)
+	double lanes[2];
+	__m128d acc = _mm_setzero_pd();
+	for (; i + 2 <= n; i += 2) acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+	_mm_storeu_pd(lanes, acc);
+	for (int l = 0; l != 2; l++) sum += lanes[l];
+#endif
+	for (; i < n; i++) sum += a[i] * b[i];
+	return sum;
+}
+
+/* Dot product of two float vectors */
+inline float SimdDotFloat(const float *a, const float *b, long long n)
+{
+	long long i = 0;
+	float sum = 0;
+#if defined(__AVX__)
+	float lanes[8];
+	__m256 acc = _mm256_setzero_ps();
+	for (; i + 8 <= n; i += 8) acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+	_mm256_storeu_ps(lanes, acc);
+	for (int l = 0; l != 8; l++) sum += lanes[l];
+#elif defined(__SSE2__)
+	float lanes[4];
+	__m128 acc = _mm_setzero_ps();
+	for (; i + 4 <= n; i += 4) acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+	_mm_storeu_ps(lanes, acc);
+	for (int l = 0; l != 4; l++) sum += lanes[l];
+#endif
+	for (; i < n; i++) sum += a[i] * b[i];
+	return sum;
+}
+
+/* Norms of rows [begin, end) of a column-major matrix, accumulated column by column */
+inline void RowNorms(const double *vec, long long rows, long long dim, long long begin, long long end, double *len)
+{
+	for (long long r = begin; r != end; r++) len[r] = 0;
+	for (long long c = 0; c != dim; c++) SimdSquareAdd(len + begin, vec + c * rows + begin, end - begin);
+	SimdSqrt(len + begin, end - begin);
+}
+#endif
@@ -0,0 +1,288 @@
+/*
+Exact top-k most similar rows of an embedding matrix, the brute-force counterpart of the HNSW
+index used to validate it.
+
+The rows are normalized once and packed into panels of PANEL rows, column by column, so the
+micro-kernel streams both operands contiguously. The scores of a block of ROW_BLOCK rows against
+a block of COL_BLOCK rows are computed PANEL x PANEL at a time and immediately folded into a
+bounded min-heap of the k best rows of every row in the row block; only one block of scores
+exists per thread. Row blocks are split across threads. Every score is summed in the same order
+whatever the number of threads, and ties are broken by the lower row number, so the result is
+deterministic.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <R.h>
+#include "perf_counters.h"
+#include "trace.h"
+#include "simd.h"
+#include "parallel.h"
+#include "similarity.h"
+
+#define PANEL 8            // rows packed together; the micro-kernel computes PANEL x PANEL scores
+#define ROW_BLOCK 64       // rows whose heaps are updated together; their panels stay in L2
+#define COL_BLOCK 256      // rows scored against a row block at once; ROW_BLOCK x COL_BLOCK scores
+
+static long long num_rows = 0, vector_dim = 0;
+static int top_k = 10, exclude_self = 1;
+static const double *vec;
+static double *packed;     // ceil(num_rows / PANEL) panels of vector_dim x PANEL
+static int *result_ids;
+static double *result_similarity;
+
+/* Normalize the rows of panels [begin, end) into packed; rows past num_rows are zero */
+static void PackTask(long long begin, long long end, void *arg)
+{
+	int normalize = *(int *)arg;
+	for (long long p = begin; p != end; p++)
+	{
+		double len[PANEL];
+		double *panel = packed + p * vector_dim * PANEL;
+		for (int r = 0; r != PANEL; r++) len[r] = 0;
+		for (long long c = 0; c != vector_dim; c++)
+			for (int r = 0; r != PANEL; r++)
+			{
+				long long row = p * PANEL + r;
+				double x = row < num_rows ? vec[c * num_rows + row] : 0;
+				panel[c * PANEL + r] = x;
+				len[r] += x * x;
+			}
+		for (int r = 0; r != PANEL; r++) len[r] = normalize && len[r] > 0 ? sqrt(len[r]) : 1;
+		for (long long c = 0; c != vector_dim; c++)
+			for (int r = 0; r != PANEL; r++) panel[c * PANEL + r] /= len[r];
+	}
+}
+
+/* scores[j * ld + i] = dot product of row i of panel a and row j of panel b */
+static inline void Kernel(const double *a, const double *b, long long dim, double *scores, long long ld)
+{
+#if defined(__AVX__)
+	for (int jh = 0; jh != PANEL; jh += 4)
+	{
+		__m256d s00 = _mm256_setzero_pd(), s01 = _mm256_setzero_pd(), s10 = _mm256_setzero_pd(), s11 = _mm256_setzero_pd();
+		__m256d s20 = _mm256_setzero_pd(), s21 = _mm256_setzero_pd(), s30 = _mm256_setzero_pd(), s31 = _mm256_setzero_pd();
+		for (long long c = 0; c != dim; c++)
+		{
+			__m256d a0 = _mm256_loadu_pd(a + c * PANEL), a1 = _mm256_loadu_pd(a + c * PANEL + 4);
+			const double *bc = b + c * PANEL + jh;
+			__m256d bj = _mm256_broadcast_sd(bc);
+			s00 = _mm256_add_pd(s00, _mm256_mul_pd(a0, bj));
+			s01 = _mm256_add_pd(s01, _mm256_mul_pd(a1, bj));
+			bj = _mm256_broadcast_sd(bc + 1);
+			s10 = _mm256_add_pd(s10, _mm256_mul_pd(a0, bj));
+			s11 = _mm256_add_pd(s11, _mm256_mul_pd(a1, bj));
+			bj = _mm256_broadcast_sd(bc + 2);
+			s20 = _mm256_add_pd(s20, _mm256_mul_pd(a0, bj));
+			s21 = _mm256_add_pd(s21, _mm256_mul_pd(a1, bj));
+			bj = _mm256_broadcast_sd(bc + 3);
+			s30 = _mm256_add_pd(s30, _mm256_mul_pd(a0, bj));
+			s31 = _mm256_add_pd(s31, _mm256_mul_pd(a1, bj));
+		}
+		double *out = scores + jh * ld;
+		_mm256_storeu_pd(out, s00);
+		_mm256_storeu_pd(out + 4, s01);
+		_mm256_storeu_pd(out + ld, s10);
+		_mm256_storeu_pd(out + ld + 4, s11);
+		_mm256_storeu_pd(out + 2 * ld, s20);
+		_mm256_storeu_pd(out + 2 * ld + 4, s21);
+		_mm256_storeu_pd(out + 3 * ld, s30);
+		_mm256_storeu_pd(out + 3 * ld + 4, s31);
+	}
+#elif defined(__SSE2__)
+	for (int jh = 0; jh != PANEL; jh += 2)
+	{
+		__m128d s00 = _mm_setzero_pd(), s01 = _mm_setzero_pd(), s02 = _mm_setzero_pd(), s03 = _mm_setzero_pd();
+		__m128d s10 = _mm_setzero_pd(), s11 = _mm_setzero_pd(), s12 = _mm_setzero_pd(), s13 = _mm_setzero_pd();
+		for (long long c = 0; c != dim; c++)
+		{
+			const double *ac = a + c * PANEL;
+			__m128d a0 = _mm_loadu_pd(ac), a1 = _mm_loadu_pd(ac + 2), a2 = _mm_loadu_pd(ac + 4), a3 = _mm_loadu_pd(ac + 6);
+			__m128d bj = _mm_set1_pd(b[c * PANEL + jh]);
+			s00 = _mm_add_pd(s00, _mm_mul_pd(a0, bj));
+			s01 = _mm_add_pd(s01, _mm_mul_pd(a1, bj));
+			s02 = _mm_add_pd(s02, _mm_mul_pd(a2, bj));
+			s03 = _mm_add_pd(s03, _mm_mul_pd(a3, bj));
+			bj = _mm_set1_pd(b[c * PANEL + jh + 1]);
+			s10 = _mm_add_pd(s10, _mm_mul_pd(a0, bj));
+			s11 = _mm_add_pd(s11, _mm_mul_pd(a1, bj));
+			s12 = _mm_add_pd(s12, _mm_mul_pd(a2, bj));
+			s13 = _mm_add_pd(s13, _mm_mul_pd(a3, bj));
+		}
+		double *out = scores + jh * ld;
+		_mm_storeu_pd(out, s00);
+		_mm_storeu_pd(out + 2, s01);
+		_mm_storeu_pd(out + 4, s02);
+		_mm_storeu_pd(out + 6, s03);
+		_mm_storeu_pd(out + ld, s10);
+		_mm_storeu_pd(out + ld + 2, s11);
+		_mm_storeu_pd(out + ld + 4, s12);
+		_mm_storeu_pd(out + ld + 6, s13);
+	}
+#else
+	for (int j = 0; j != PANEL; j++)
+	{
+		double s[PANEL];
+		for (int i = 0; i != PANEL; i++) s[i] = 0;
+		for (long long c = 0; c != dim; c++)
+			for (int i = 0; i != PANEL; i++) s[i] += a[c * PANEL + i] * b[c * PANEL + j];
+		for (int i = 0; i != PANEL; i++) scores[j * ld + i] = s[i];
+	}
+#endif
+}
+
+/* 1 when (s1, id1) ranks below (s2, id2): a lower score, or the same score and a higher row */
+static inline int Worse(double s1, int id1, double s2, int id2)
+{
+	return s1 < s2 || (s1 == s2 && id1 > id2);
+}
+
+/* Offer (score, id) to a min-heap of at most top_k entries with the worst entry on top */
+static void HeapOffer(double *heap_score, int *heap_id, int &size, double score, int id)
+{
+	int i;
+	if (size < top_k) i = size++;
+	else
+	{
+		if (!Worse(heap_score[0], heap_id[0], score, id)) return;
+		// Sift the new entry down from the root
+		i = 0;
+		while (1)
+		{
+			int child = 2 * i + 1;
+			if (child >= size) break;
+			if (child + 1 < size && Worse(heap_score[child + 1], heap_id[child + 1], heap_score[child], heap_id[child])) child++;
+			if (!Worse(heap_score[child], heap_id[child], score, id)) break;
+			heap_score[i] = heap_score[child];
+			heap_id[i] = heap_id[child];
+			i = child;
+		}
+		heap_score[i] = score;
+		heap_id[i] = id;
+		return;
+	}
+	while (i > 0 && Worse(score, id, heap_score[(i - 1) / 2], heap_id[(i - 1) / 2]))
+	{
+		heap_score[i] = heap_score[(i - 1) / 2];
+		heap_id[i] = heap_id[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	heap_score[i] = score;
+	heap_id[i] = id;
+}
+
+static void TopKTask(long long begin, long long end, void *arg)
+{
+	long long num_panels = (num_rows + PANEL - 1) / PANEL;
+	std::vector<double> scores(ROW_BLOCK * COL_BLOCK), heap_score(ROW_BLOCK * top_k), threshold(ROW_BLOCK);
+	std::vector<int> heap_id(ROW_BLOCK * top_k), heap_size(ROW_BLOCK);
+
+	for (long long ib = begin; ib < end; ib += ROW_BLOCK)
+	{
+		long long ie = ib + ROW_BLOCK < end ? ib + ROW_BLOCK : end, ni = ie - ib;
+		long long pi_end = (ie + PANEL - 1) / PANEL;
+		for (long long i = 0; i != ni; i++)
+		{
+			heap_size[i] = 0;
+			threshold[i] = -INFINITY;
+		}
+
+		for (long long jb = 0; jb < num_rows; jb += COL_BLOCK)
+		{
+			long long je = jb + COL_BLOCK < num_rows ? jb + COL_BLOCK : num_rows;
+			long long pj_end = (je + PANEL - 1) / PANEL < num_panels ? (je + PANEL - 1) / PANEL : num_panels;
+			for (long long pj = jb / PANEL; pj != pj_end; pj++)
+				for (long long pi = ib / PANEL; pi != pi_end; pi++)
+					Kernel(packed + pi * vector_dim * PANEL, packed + pj * vector_dim * PANEL, vector_dim,
+					       &scores[(pj * PANEL - jb) * ROW_BLOCK + (pi * PANEL - ib)], ROW_BLOCK);
+
+			for (long long j = jb; j != je; j++)
+			{
+				const double *s = &scores[(j - jb) * ROW_BLOCK];
+				for (long long i = 0; i != ni; i++)
+				{
+					if (!(s[i] >= threshold[i])) continue;
+					if (exclude_self && j == ib + i) continue;
+					HeapOffer(&heap_score[i * top_k], &heap_id[i * top_k], heap_size[i], s[i], (int)j);
+					if (heap_size[i] == top_k) threshold[i] = heap_score[i * top_k];
+				}
+			}
+		}
+
+		// Pop the heaps worst first into the last filled column
+		for (long long i = 0; i != ni; i++)
+		{
+			double *hs = &heap_score[i * top_k];
+			int *hi = &heap_id[i * top_k];
+			for (int r = top_k - 1; r >= heap_size[i]; r--)
+			{
+				result_ids[r * num_rows + ib + i] = -1;
+				result_similarity[r * num_rows + ib + i] = NAN;
+			}
+			for (int r = heap_size[i] - 1; r >= 0; r--)
+			{
+				result_ids[r * num_rows + ib + i] = hi[0];
+				result_similarity[r * num_rows + ib + i] = hs[0];
+				int size = r, last_id = hi[r];
+				double last_score = hs[r];
+				// Move the last entry to the root and sift it down
+				int p = 0;
+				while (1)
+				{
+					int child = 2 * p + 1;
+					if (child >= size) break;
+					if (child + 1 < size && Worse(hs[child + 1], hi[child + 1], hs[child], hi[child])) child++;
+					if (!Worse(hs[child], hi[child], last_score, last_id)) break;
+					hs[p] = hs[child];
+					hi[p] = hi[child];
+					p = child;
+				}
+				hs[p] = last_score;
+				hi[p] = last_id;
+			}
+		}
+	}
+}
+
+/* The k rows most similar to every row of a column-major rows x dim matrix by cosine similarity
+   (or inner product when normalize is 0), written column-major into rows x k id and similarity
+   matrices, most similar first; id -1 where the matrix has fewer rows */
+void TopKSimilarityMain(const double *embedding, long long rows, long long dim, int k, int *output_ids, double *output_similarity,
+                        int normalize, int exclude_self_param, int num_threads)
+{
+	TRACE_SCOPE("TopKSimilarityMain");
+	PerfReset();
+	num_rows = rows;
+	vector_dim = dim;
+	top_k = k;
+	exclude_self = exclude_self_param;
+	vec = embedding;
+	result_ids = output_ids;
+	result_similarity = output_similarity;
+
+	long long num_panels = (num_rows + PANEL - 1) / PANEL;
+	packed = (double *)malloc(num_panels * vector_dim * PANEL * sizeof(double) + 1);
+	if (packed == NULL)
+	{
+		Rprintf("Error: memory allocation failed\n");
+		for (long long i = 0; i != rows * k; i++)
+		{
+			result_ids[i] = -1;
+			result_similarity[i] = NAN;
+		}
+		return;
+	}
+
+	PerfCounters pc;
+	PerfStart(&pc, "top k pack");
+	ParallelFor(num_panels, 1, num_threads, PackTask, &normalize);
+	PerfStop(&pc);
+	PerfStart(&pc, "top k similarity");
+	ParallelFor(num_rows, ROW_BLOCK, num_threads, TopKTask, NULL);
+	PerfStop(&pc);
+	PerfPrint();
+	free(packed);
+	packed = NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef SIMILARITY_H
+#define SIMILARITY_H
+
+void TopKSimilarityMain(const double *embedding, long long rows, long long dim, int k, int *output_ids, double *output_similarity,
+                        int normalize = 1, int exclude_self = 1, int num_threads = 1);
+#endif
@@ -0,0 +1,187 @@
+/*
+Chrome trace (about://tracing, Perfetto) timeline of the native code.
+
+Every thread appends complete events to its own buffer, a linked list of fixed size blocks
+that only the owning thread writes to, so recording an event never takes a lock. Buffers are
+published once, when a thread records its first event, by pushing them on a global list with
+a compare and swap. TraceStop is called from the main R thread after all workers have been
+joined and writes every buffer to the JSON file given to TraceStart.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <string>
+#include "trace.h"
+
+#define TRACE_BLOCK_SIZE 4096
+
+struct TraceRecord {
+	const char *name;
+	double start, end;
+};
+
+struct TraceBlock {
+	TraceRecord records[TRACE_BLOCK_SIZE];
+	int count;
+	TraceBlock *next;
+};
+
+struct TraceBuffer {
+	TraceBlock *head, *tail;
+	const char *thread_name;
+	int tid;
+	TraceBuffer *next;
+};
+
+static std::atomic<TraceBuffer *> trace_buffers(NULL);
+static std::atomic<int> trace_enabled(0), trace_next_tid(0);
+static std::atomic<unsigned> trace_generation(0);
+static thread_local TraceBuffer *local_buffer = NULL;
+static thread_local unsigned local_generation = 0;    // trace local_buffer belongs to, it is freed once that trace ends
+static std::string trace_file;
+static double trace_origin = 0;
+
+static double MonotonicMicroseconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+/* Buffer of the calling thread for the current trace, created on first use. The buffer of an
+   earlier trace has been freed, so only the generation kept by the thread tells whether
+   local_buffer is still valid. */
+static TraceBuffer *LocalBuffer()
+{
+	unsigned generation = trace_generation.load(std::memory_order_acquire);
+	if (local_buffer != NULL && local_generation == generation) return local_buffer;
+	local_buffer = NULL;
+
+	TraceBuffer *buffer = (TraceBuffer *)calloc(1, sizeof(TraceBuffer));
+	if (buffer == NULL) return NULL;
+	buffer->head = buffer->tail = (TraceBlock *)calloc(1, sizeof(TraceBlock));
+	if (buffer->head == NULL) { free(buffer); return NULL; }
+	buffer->thread_name = trace_next_tid.load() == 0 ? "main" : "worker";
+	buffer->tid = trace_next_tid.fetch_add(1);
+	buffer->next = trace_buffers.load(std::memory_order_relaxed);
+	while (!trace_buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed));
+	local_buffer = buffer;
+	local_generation = generation;
+	return buffer;
+}
+
+static void FreeBuffers()
+{
+	TraceBuffer *buffer = trace_buffers.exchange(NULL);
+	while (buffer != NULL)
+	{
+		TraceBuffer *next_buffer = buffer->next;
+		TraceBlock *block = buffer->head;
+		while (block != NULL)
+		{
+			TraceBlock *next_block = block->next;
+			free(block);
+			block = next_block;
+		}
+		free(buffer);
+		buffer = next_buffer;
+	}
+}
+
+static void WriteString(FILE *fo, const char *str)
+{
+	fputc('"', fo);
+	for (; *str; str++)
+	{
+		if (*str == '"' || *str == '\\') fputc('\\', fo);
+		fputc(*str, fo);
+	}
+	fputc('"', fo);
+}
+
+double TraceNow()
+{
+	return MonotonicMicroseconds() - trace_origin;
+}
+
+int TraceEnabled()
+{
+	return trace_enabled.load(std::memory_order_relaxed);
+}
+
+int TraceStart(const char *file)
+{
+	FILE *fo = fopen(file, "wb");
+	if (fo == NULL) return 0;
+	fclose(fo);
+
+	trace_enabled.store(0);
+	FreeBuffers();
+	trace_file = file;
+	trace_next_tid.store(0);
+	trace_generation.fetch_add(1, std::memory_order_release);
+	trace_origin = MonotonicMicroseconds();
+	trace_enabled.store(1);
+	return 1;
+}
+
+void TraceThreadName(const char *name)
+{
+	if (!TraceEnabled()) return;
+	TraceBuffer *buffer = LocalBuffer();
+	if (buffer != NULL) buffer->thread_name = name;
+}
+
+void TraceEvent(const char *name, double start_us, double end_us)
+{
+	if (!TraceEnabled()) return;
+	TraceBuffer *buffer = LocalBuffer();
+	if (buffer == NULL) return;
+	TraceBlock *block = buffer->tail;
+	if (block->count == TRACE_BLOCK_SIZE)
+	{
+		TraceBlock *next_block = (TraceBlock *)calloc(1, sizeof(TraceBlock));
+		if (next_block == NULL) return;
+		block->next = next_block;
+		buffer->tail = block = next_block;
+	}
+	TraceRecord &record = block->records[block->count++];
+	record.name = name;
+	record.start = start_us;
+	record.end = end_us;
+}
+
+/* Write the trace and stop recording; returns the number of events written or -1 */
+int TraceStop()
+{
+	if (!TraceEnabled()) return -1;
+	trace_enabled.store(0);
+
+	FILE *fo = fopen(trace_file.c_str(), "wb");
+	if (fo == NULL) { FreeBuffers(); return -1; }
+	int num_events = 0;
+	fprintf(fo, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (TraceBuffer *buffer = trace_buffers.load(std::memory_order_acquire); buffer != NULL; buffer = buffer->next)
+	{
+		fprintf(fo, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", num_events ? ",\n" : "", buffer->tid);
+		WriteString(fo, buffer->thread_name);
+		fprintf(fo, "}}");
+		num_events++;
+		for (TraceBlock *block = buffer->head; block != NULL; block = block->next)
+			for (int k = 0; k != block->count; k++)
+			{
+				const TraceRecord &record = block->records[k];
+				fprintf(fo, ",\n{\"ph\":\"X\",\"cat\":\"rline\",\"name\":");
+				WriteString(fo, record.name);
+				fprintf(fo, ",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", buffer->tid, record.start, record.end - record.start);
+				num_events++;
+			}
+	}
+	fprintf(fo, "\n]}\n");
+	fclose(fo);
+	FreeBuffers();
+	return num_events;
+}
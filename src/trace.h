@@ -0,0 +1,25 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+int TraceStart(const char *file);
+int TraceStop();
+int TraceEnabled();
+void TraceThreadName(const char *name);
+void TraceEvent(const char *name, double start_us, double end_us);
+double TraceNow();
+
+/* Records a complete event covering the lifetime of the scope */
+class TraceScope {
+public:
+	TraceScope(const char *name) : name_(name), start_(TraceEnabled() ? TraceNow() : -1) {}
+	~TraceScope() { if (start_ >= 0) TraceEvent(name_, start_, TraceNow()); }
+private:
+	const char *name_;
+	double start_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+#endif
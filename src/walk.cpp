@@ -0,0 +1,271 @@
+/*
+DeepWalk and node2vec embeddings trained on the LINE infrastructure.
+
+Random walks are generated on several threads from per-vertex alias tables of the out-edge
+weights. node2vec's second order bias, 1/p to return to the previous vertex, 1 to a neighbor of
+it and 1/q to move away, is applied by rejection: a neighbor drawn from the first order alias
+table is kept with probability bias / max bias, which needs a binary search in the sorted
+neighbors of the previous vertex instead of an alias table per edge. With p = q = 1 this is
+DeepWalk and nothing is rejected.
+
+Every walk is streamed into a skip-gram trainer as soon as it is generated: the pairs within a
+window of it are trained with line's negative sampling and update, the vertex row against the
+context row, so only one walk per thread is ever held in memory.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <R.h>
+#include "line_kernel.h"
+#include "sampling.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "parallel.h"
+#include "memory_planner.h"
+#include "walk.h"
+
+#define ALIAS_BLOCK 1024
+#define PROGRESS_WALKS 100        // walks between updates of the shared progress and learning rate
+
+static int dim = 100, walk_length = 80, num_walks = 10, window = 10, num_negative = 5, num_threads = 1;
+static long long num_vertices = 0, total_walks = 0, neg_table_size = 0;
+static double inv_p = 1, inv_q = 1, max_bias = 1;
+static real init_rho = 0.025;
+static real *emb_vertex, *emb_context, *sigmoid_table;
+static long long *offset;                 // out-edges of vertex k are [offset[k], offset[k + 1]), sorted by neighbor
+static int *neighbor, *alias, *start_order, *neg_table;
+static double *prob, *vertex_degree;
+static unsigned long long base_seed = 0;
+static std::atomic<long long> walks_done(0);
+
+static void FreeWalk()
+{
+	free(emb_vertex); emb_vertex = NULL;
+	free(emb_context); emb_context = NULL;
+	free(sigmoid_table); sigmoid_table = NULL;
+	free(offset); offset = NULL;
+	free(neighbor); neighbor = NULL;
+	free(alias); alias = NULL;
+	free(start_order); start_order = NULL;
+	free(neg_table); neg_table = NULL;
+	free(prob); prob = NULL;
+	free(vertex_degree); vertex_degree = NULL;
+}
+
+static double Degree(long long k)
+{
+	return vertex_degree[k];
+}
+
+static double UnitDegree(long long k)
+{
+	return 1;
+}
+
+/* Build the alias tables of the out-edges of vertices [begin, end); prob holds the weights on
+   entry. Sets *failed if the scratch memory cannot be allocated. */
+static void AliasTask(long long begin, long long end, void *arg)
+{
+	std::vector<double> weight;
+	for (long long k = begin; k != end; k++)
+	{
+		long long first = offset[k], degree = offset[k + 1] - first;
+		if (degree == 0) continue;
+		weight.assign(prob + first, prob + first + degree);
+		if (!FillAliasTable(&weight[0], degree, alias + first, prob + first)) *(int *)arg = 1;
+	}
+}
+
+static inline bool IsNeighbor(long long u, long long v)
+{
+	return std::binary_search(neighbor + offset[u], neighbor + offset[u + 1], (int)v);
+}
+
+/* The next vertex of a walk at cur that came from prev, or -1 at a vertex without out-edges */
+static inline long long NextVertex(long long prev, long long cur, unsigned long long &seed)
+{
+	long long first = offset[cur], degree = offset[cur + 1] - first;
+	if (degree == 0) return -1;
+	while (1)
+	{
+		long long next = neighbor[first + SampleAlias(prob + first, alias + first, degree, FastUniform(seed), FastUniform(seed))];
+		if (prev < 0 || max_bias == 1) return next;
+		double bias = next == prev ? inv_p : IsNeighbor(prev, next) ? 1 : inv_q;
+		if (FastUniform(seed) * max_bias < bias) return next;
+	}
+}
+
+static void WalkThread(long long begin, long long end, void *arg)
+{
+	long long *walk = (long long *)malloc(walk_length * sizeof(long long));
+	real *vec_error = (real *)calloc(dim, sizeof(real));
+	for (long long id = begin; id != end; id++)
+	{
+		long long first = total_walks * id / num_threads, last = total_walks * (id + 1) / num_threads;
+		real rho = init_rho;
+		PerfCounters pc;
+		PerfStart(&pc, "walk thread", (int)id);
+		TraceThreadName("walk train thread");
+
+		for (long long w = first; w != last; w++)
+		{
+			if ((w - first) % PROGRESS_WALKS == 0)
+			{
+				long long done = w == first ? walks_done.load() : walks_done.fetch_add(PROGRESS_WALKS) + PROGRESS_WALKS;
+				rho = init_rho * (1 - done / (real)(total_walks + 1));
+				if (rho < init_rho * 0.0001) rho = init_rho * 0.0001;
+			}
+
+			// The walk of w only depends on w, not on the number of threads
+			unsigned long long seed = base_seed + (unsigned long long)w * 0x9E3779B97F4A7C15ULL;
+			int length = 1;
+			walk[0] = start_order[w % num_vertices];
+			for (; length != walk_length; length++)
+			{
+				walk[length] = NextVertex(length == 1 ? -1 : walk[length - 2], walk[length - 1], seed);
+				if (walk[length] == -1) break;
+			}
+
+			// Skip-gram with a window shrunk at random for every position, as word2vec does
+			for (int i = 0; i != length; i++)
+			{
+				int reach = window - (int)FastRand(seed, window);
+				real *vec_u = &emb_vertex[walk[i] * dim];
+				for (int j = i - reach; j <= i + reach; j++)
+				{
+					if (j < 0 || j == i || j >= length) continue;
+					for (int c = 0; c != dim; c++) vec_error[c] = 0;
+					for (int d = 0; d != num_negative + 1; d++)
+					{
+						long long target = d == 0 ? walk[j] : neg_table[FastRand(seed, neg_table_size)];
+						if (d != 0 && target == walk[j]) continue;
+						Update(vec_u, &emb_context[target * dim], vec_error, d == 0, dim, rho, sigmoid_table);
+					}
+					for (int c = 0; c != dim; c++) vec_u[c] += vec_error[c];
+				}
+			}
+		}
+		PerfStop(&pc);
+	}
+	free(walk);
+	free(vec_error);
+}
+
+/* Train a num_vertices x dim embedding from num_walks walks of walk_length vertices starting at
+   every vertex of the directed graph given by 0-based edges. Writes the column-major embedding to
+   output_vectors; returns 0 if out of memory. */
+int TrainWalkMain(const int *source, const int *target, const double *weight, long long num_edges, long long num_vertices_param,
+                  int dim_param, int walk_length_param, int num_walks_param, int window_param, double p_param, double q_param,
+                  int num_negative_param, float init_rho_param, int num_threads_param, double *output_vectors)
+{
+	TRACE_SCOPE("TrainWalkMain");
+	PerfReset();
+	num_vertices = num_vertices_param;
+	dim = dim_param;
+	walk_length = walk_length_param < 1 ? 1 : walk_length_param;
+	num_walks = num_walks_param;
+	window = window_param < 1 ? 1 : window_param;
+	inv_p = 1 / p_param;
+	inv_q = 1 / q_param;
+	max_bias = std::max(std::max(inv_p, inv_q), 1.0);
+	num_negative = num_negative_param;
+	init_rho = init_rho_param;
+	num_threads = num_threads_param < 1 ? 1 : num_threads_param;
+	total_walks = num_vertices * num_walks;
+	walks_done = 0;
+
+	neg_table_size = 100 * num_vertices;
+	if (neg_table_size < min_neg_table_size) neg_table_size = min_neg_table_size;
+	if (neg_table_size > default_neg_table_size) neg_table_size = default_neg_table_size;
+	emb_vertex = (real *)malloc(num_vertices * dim * sizeof(real) + 1);
+	emb_context = (real *)malloc(num_vertices * dim * sizeof(real) + 1);
+	sigmoid_table = (real *)malloc((sigmoid_table_size + 1) * sizeof(real));
+	offset = (long long *)calloc(num_vertices + 1, sizeof(long long));
+	neighbor = (int *)malloc(num_edges * sizeof(int) + 1);
+	alias = (int *)malloc(num_edges * sizeof(int) + 1);
+	prob = (double *)malloc(num_edges * sizeof(double) + 1);
+	start_order = (int *)malloc(num_vertices * sizeof(int) + 1);
+	neg_table = (int *)malloc(neg_table_size * sizeof(int));
+	vertex_degree = (double *)calloc(num_vertices + 1, sizeof(double));
+	if (emb_vertex == NULL || emb_context == NULL || sigmoid_table == NULL || offset == NULL || neighbor == NULL ||
+	    alias == NULL || prob == NULL || start_order == NULL || neg_table == NULL || vertex_degree == NULL)
+	{
+		Rprintf("Error: memory allocation failed\n");
+		FreeWalk();
+		return 0;
+	}
+
+	PerfCounters pc;
+	PerfStart(&pc, "walk setup");
+	// Out-edges grouped by source with a counting sort, then sorted by neighbor; edges without a
+	// positive weight (NA included) cannot be walked and are left out of the degrees too
+	for (long long e = 0; e != num_edges; e++)
+	{
+		if (!(weight[e] > 0)) continue;
+		vertex_degree[source[e]] += weight[e];
+		vertex_degree[target[e]] += weight[e];
+		offset[source[e] + 1]++;
+	}
+	for (long long k = 0; k != num_vertices; k++) offset[k + 1] += offset[k];
+	{
+		std::vector<long long> next(offset, offset + num_vertices);
+		std::vector< std::pair<int, double> > edges(offset[num_vertices]);
+		for (long long e = 0; e != num_edges; e++)
+			if (weight[e] > 0) edges[next[source[e]]++] = std::make_pair(target[e], weight[e]);
+		for (long long k = 0; k != num_vertices; k++) std::sort(edges.begin() + offset[k], edges.begin() + offset[k + 1]);
+		for (long long e = 0; e != offset[num_vertices]; e++)
+		{
+			neighbor[e] = edges[e].first;
+			prob[e] = edges[e].second;
+		}
+	}
+	int failed = 0;
+	ParallelFor(num_vertices, ALIAS_BLOCK, num_threads, AliasTask, &failed);
+	if (failed)
+	{
+		PerfStop(&pc);
+		Rprintf("Error: memory allocation failed\n");
+		FreeWalk();
+		return 0;
+	}
+
+	GetRNGstate();
+	for (long long k = 0; k != num_vertices; k++)
+		for (int c = 0; c != dim; c++)
+		{
+			emb_vertex[k * dim + c] = (unif_rand() - 0.5) / dim;
+			emb_context[k * dim + c] = 0;
+		}
+	for (long long k = 0; k != num_vertices; k++)
+	{
+		long long r = (long long)(unif_rand() * (k + 1));
+		start_order[k] = start_order[r];
+		start_order[r] = (int)k;
+	}
+	base_seed = (unsigned long long)(unif_rand() * 4294967296.0);
+	PutRNGstate();
+	double sum = 0;
+	for (long long k = 0; k != num_vertices; k++) sum += vertex_degree[k];
+	if (sum > 0) FillNegTable(neg_table, neg_table_size, num_vertices, Degree);
+	else FillNegTable(neg_table, neg_table_size, num_vertices, UnitDegree);
+	InitSigmoidTable(sigmoid_table);
+	PerfStop(&pc);
+
+	if (total_walks > 0)
+	{
+		PerfStart(&pc, "walk train");
+		ParallelFor(num_threads, 1, num_threads, WalkThread, NULL);
+		PerfStop(&pc);
+	}
+	PerfPrint();
+
+	for (long long k = 0; k != num_vertices; k++)
+		for (int c = 0; c != dim; c++) output_vectors[c * num_vertices + k] = emb_vertex[k * dim + c];
+	FreeWalk();
+	return 1;
+}
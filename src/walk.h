@@ -0,0 +1,7 @@
+#ifndef WALK_H
+#define WALK_H
+
+int TrainWalkMain(const int *source, const int *target, const double *weight, long long num_edges, long long num_vertices,
+                  int dim_param, int walk_length_param, int num_walks_param, int window_param, double p_param, double q_param,
+                  int num_negative_param, float init_rho_param, int num_threads_param, double *output_vectors);
+#endif